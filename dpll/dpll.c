@@ -14,495 +14,5651 @@
   #define fseeko _fseeki64
   typedef __int64 off_t;
 
+  // MSVC has no ESTALE.
+  #define ESTALE EINVAL
+
   #define _CRT_SECURE_NO_WARNINGS
   #pragma warning(disable : 4127)  //  conditional expression is constant
 #else
   #define PRsize_t "%zu"
 #endif
 
-#include "dpll.h"
-#include <assert.h>
-#include <ctype.h>  // isspace
-#include <errno.h>
-#include <limits.h>
-#include <math.h>
-#include <stdarg.h>
-#include <stdlib.h>
+#include "dpll.h"
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>  // memcpy
+#include <sys/stat.h>  // stat
+
+#ifndef _MSC_VER
+  #include <pthread.h>
+  #include <sys/mman.h>  // mmap
+  #include <unistd.h>  // sysconf
+#endif
+
+// Compressed input is supported for the libraries that are enabled
+// in the Craftfile.
+#ifdef DPLL_HAVE_ZLIB
+  #include <zlib.h>
+#endif
+#ifdef DPLL_HAVE_LZMA
+  #include <lzma.h>
+#endif
+#ifdef DPLL_HAVE_BZLIB
+  #include <bzlib.h>
+#endif
+
+// The initial capacity of a clause and clause_set. The literal buffer
+// of a clause_set starts with the product of both. All buffers double
+// their capacity when they are full.
+static size_t const clause_chunksize = 16;
+static size_t const clause_set_chunksize = 128;
+
+// The clause length up to which clause_builder_add() compares a new
+// literal with the literals of the clause instead of the stamps.
+static size_t const clause_builder_scan_limit = 8;
+
+// The clause reference that denotes no clause, eg. the reason of a
+// decision or a unit clause.
+static uint32_t const no_clause = UINT32_MAX;
+
+// The clause reference that denotes a binary clause. Binary clauses
+// are not stored in the arena, see solver#binaries.
+static uint32_t const binary_clause = UINT32_MAX - 1;
+
+// The literal that denotes no literal.
+static uint32_t const no_lit = UINT32_MAX;
+
+// The heap position of a variable that is not in the heap.
+static size_t const not_in_heap = (size_t) -1;
+
+// The factor by which the variable activities decay after each
+// conflict, and the limit at which they are rescaled.
+static double const var_decay = 0.95;
+static double const var_activity_limit = 1e100;
+
+// The same for the activities of the learned clauses.
+static double const clause_decay = 0.999;
+static double const clause_activity_limit = 1e20;
+
+// Learned clauses with an LBD up to this value (glue clauses) are
+// never deleted.
+static size_t const glue_lbd = 2;
+
+// Learned clauses with up to this number of literals are minimized with
+// binary clauses.
+static size_t const minimize_binary_limit = 30;
+
+// A variable is only eliminated if the resolvents of its clauses have
+// at most #elim_resolvent_limit literals and one of its literals occurs
+// in at most #elim_occ_limit clauses.
+static size_t const elim_resolvent_limit = 20;
+static size_t const elim_occ_limit = 16;
+
+// Returned by simplifier_resolve() if the resolvent is a tautology.
+static size_t const no_resolvent = (size_t) -1;
+
+// Probing adds at most this many hyper-binary resolvents per variable
+// in total.
+static size_t const probe_hbr_limit = 1;
+
+// Learned units and binary clauses are shared with the other solvers of
+// a portfolio, as well as learned clauses with at most
+// #share_size_limit literals and an LBD up to #share_lbd_limit.
+static size_t const share_size_limit = 30;
+static size_t const share_lbd_limit = 3;
+
+// The number of 32-bit words of the ring buffer through which a solver
+// of a portfolio shares its clauses, a power of two.
+static size_t const share_ring_words = 1 << 16;
+
+// The LBD is stored in clause_header#flags above the clause_flag bits.
+static unsigned const clause_lbd_shift = 4;
+
+// The size of the blocks in which input that can not be mapped into
+// memory is read.
+static size_t const input_blocksize = 1 << 20;
+
+// The minimum number of bytes of clauses parsed by one thread of
+// clause_set_parse_parallel().
+static size_t const parse_chunksize = 1 << 22;
+
+// The complete input of clause_set_parse(), either mapped into memory
+// or read into a buffer allocated with malloc().
+struct input
+{
+  char* data;
+  size_t size;
+
+  // The start and the size of the mapping if the input is mapped, in
+  // which case #data points into the mapping.
+  void* map;
+  size_t map_size;
+};
+
+// The position of the parser in the input. The input is not zero
+// terminated, every read is checked against #end.
+struct cursor
+{
+  char const* pos;
+  char const* end;
+};
+
+// Read the remaining contents of the file into \p input, after the \p
+// prefix_size bytes of \p prefix that have already been read from it.
+// Regular files without a prefix are mapped into memory, other files
+// like pipes are read in blocks of #input_blocksize bytes. Return false
+// on error and set #errno.
+static bool input_load(
+  struct input* input, FILE* fp, unsigned char const* prefix, size_t prefix_size);
+
+// Unmap or free the input.
+static void input_free(struct input* input);
+
+// The compression of an input, detected from its first bytes.
+enum input_format
+{
+  input_plain,
+  input_gzip,
+  input_xz,
+  input_bzip2,
+};
+
+// The number of bytes read to detect the format of an input.
+#define INPUT_MAGIC_SIZE 6
+
+// The number of decompressed blocks of #input_blocksize bytes that may
+// be queued between the decompression thread and the parser.
+#define INPUT_QUEUE_SIZE 4
+
+// Return the format of an input that starts with the specified bytes.
+static enum input_format input_detect(unsigned char const* magic, size_t size);
+
+// Return the name of a format for messages.
+static const char* input_format_name(enum input_format format);
+
+// Decompresses an input in one of the compressed formats. The bytes that
+// were read to detect the format are passed back in before the rest of
+// the file.
+struct decoder
+{
+  enum input_format format;
+  FILE* fp;
+
+  // The bytes that were already read from #fp, and the number of them
+  // that have been consumed.
+  unsigned char const* prefix;
+  size_t prefix_size;
+  size_t prefix_pos;
+
+  // A buffer of #input_blocksize bytes of compressed input.
+  unsigned char* in;
+
+  // Set once all compressed input has been read, and once all of it
+  // has been decompressed.
+  bool eof;
+  bool finished;
+
+  union {
+#ifdef DPLL_HAVE_ZLIB
+    z_stream gzip;
+#endif
+#ifdef DPLL_HAVE_LZMA
+    lzma_stream xz;
+#endif
+#ifdef DPLL_HAVE_BZLIB
+    bz_stream bzip2;
+#endif
+    char none;
+  } stream;
+};
+
+// Initialize a decoder for the specified format. Return false if the
+// format is not supported by this build or on a memory error.
+static bool decoder_init(
+  struct decoder* decoder, enum input_format format, FILE* fp,
+  unsigned char const* prefix, size_t prefix_size);
+
+// Free the decoder. Does not close the FILE.
+static void decoder_free(struct decoder* decoder);
+
+// Decompress up to \p size bytes into \p out. Return the number of
+// bytes, which is 0 only at the end of the input, or -1 on error.
+static long decoder_read(struct decoder* decoder, char* out, size_t size);
+
+#if defined(DPLL_HAVE_ZLIB) || defined(DPLL_HAVE_LZMA) || defined(DPLL_HAVE_BZLIB)
+// Read up to #input_blocksize bytes of compressed input into
+// decoder#in, the prefix first. Return the number of bytes, 0 at the
+// end of the file.
+static size_t decoder_fill(struct decoder* decoder);
+#endif
+
+// A bounded queue of decompressed blocks between the thread that runs
+// the decoder and the parser.
+struct block_queue
+{
+#ifndef _MSC_VER
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+#endif
+  struct decoder* decoder;
+
+  // Set if the decoder runs on a thread of its own. If not, the parser
+  // runs it whenever it needs the next block.
+  bool threaded;
+
+  // A ring buffer of #count blocks starting at #head. The blocks are
+  // allocated with malloc() by the decoder thread and freed by the
+  // parser.
+  char* blocks[INPUT_QUEUE_SIZE];
+  size_t sizes[INPUT_QUEUE_SIZE];
+  size_t head;
+  size_t count;
+
+  // Set by the decoder thread at the end of the input or on an error,
+  // and by the parser when it stops early. Only accessed with #mutex
+  // held.
+  bool done;
+  bool failed;
+  bool cancel;
+};
+
+// Thread entry point that decompresses the input of a block_queue.
+static void* block_queue_thread(void* queue);
+
+// Remove the next block from the queue and store its size in \p size.
+// Return NULL at the end of the input or on an error, and set \p failed
+// on an error.
+static char* block_queue_pop(struct block_queue* queue, size_t* size, bool* failed);
+
+// Parse a DIMACS CNF from a compressed input. The decoder runs on a
+// thread of its own and the parser consumes its output block by block,
+// so that decompression and parsing overlap.
+static bool parse_compressed(
+  struct clause_set* set, FILE* fp, enum input_format format,
+  unsigned char const* magic, size_t magic_size);
+
+// The errors that can occur while the clauses are parsed. They are
+// reported once the index of the clause is known.
+enum parse_error
+{
+  parse_ok,
+  parse_error_terminator,
+  parse_error_literal,
+  parse_error_range,
+  parse_error_add_literal,
+  parse_error_add_clause,
+};
+
+// A range of complete lines of clauses that is parsed by one thread.
+struct parse_chunk
+{
+  struct cursor cur;
+  long long num_vars;
+
+  // The clause_set the clauses are added to, #local or the result of
+  // the parser, and the number of clauses it had before.
+  struct clause_set* set;
+  size_t first;
+  struct clause_set local;
+
+  // The first error, the index of the clause that caused it relative
+  // to the chunk and the offending literal.
+  enum parse_error error;
+  size_t error_index;
+  long long error_value;
+
+  // The last duplicate literal warning before the error.
+  bool warning;
+  size_t warning_index;
+  long long warning_value;
+};
+
+// Parse a DIMACS CNF from the cursor into the clause_set, splitting the
+// clauses into chunks for up to \p num_threads threads. See
+// clause_set_parse_parallel().
+static bool parse_dimacs(
+  struct clause_set* set, struct cursor* cur, size_t num_threads);
+
+// Parse the comment lines and the 'p' line at the cursor, set
+// set#num_vars and store it in \p num_vars. Return false on error.
+static bool parse_header(
+  struct clause_set* set, struct cursor* cur, long long* num_vars);
+
+// Return true if the cursor contains the comment lines and the 'p'
+// line in full, or the error that parse_header() will report.
+static bool header_complete(struct cursor const* cur);
+
+// Parse the clauses of a chunk with a builder for chunk#set until the
+// end of the chunk or the first error.
+static void parse_clauses(struct parse_chunk* chunk, struct clause_builder* builder);
+
+// Thread entry point for parse_clauses().
+static void* parse_clauses_thread(void* chunk);
+
+// Report the warning and the error of a chunk with #dpll_puterr and
+// set #errno. \p base is the index of the first clause of the chunk.
+// Return false if the chunk has an error.
+static bool parse_report(struct parse_chunk const* chunk, size_t base);
+
+// Append the clauses of \p other to \p set. Return false on a memory
+// error.
+static bool clause_set_append(struct clause_set* set, struct clause_set const* other);
+
+// The first bytes and the version of a cache file.
+static char const cache_magic[8] = "DPLLCNF";
+static uint32_t const cache_version = 1;
+
+// The value of cache_header#byte_order as written by this machine.
+static uint32_t const cache_byte_order = 0x01020304;
+
+// The header of a cache file written by clause_set_write_cache(). It
+// is followed by count + 1 offsets of 64 bits and num_lits literals of
+// 32 bits, both in the byte order of the writer.
+struct cache_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t num_vars;
+  uint64_t count;
+  uint64_t num_lits;
+
+  // The size and the modification time of the DIMACS file the cache
+  // was written for, or zero.
+  uint64_t source_size;
+  int64_t source_mtime;
+
+  // The checksum of the offsets and literals, see cache_checksum().
+  uint64_t checksum;
+};
+
+// Continue the 64-bit checksum \p hash over \p count 32-bit words.
+// The checksum starts with #cache_checksum_basis.
+static uint64_t cache_checksum(uint64_t hash, uint32_t const* words, size_t count);
+static uint64_t const cache_checksum_basis = 14695981039346656037ull;
+
+// Copy the buffers of a clause_set that was loaded from a cache out of
+// the mapping, so that they can be modified. Return false on a memory
+// error.
+static bool clause_set_unshare(struct clause_set* set);
+
+// Grow the stamps of the builder to cover \p lit and its negation.
+// Return false on a memory error.
+static bool clause_builder_reserve(struct clause_builder* builder, uint32_t lit);
+
+// Make room for \p count more clauses with \p num_lits more literals
+// in the clause_set, at least doubling the capacity of a buffer that
+// is too small. Return false on a memory error.
+static bool clause_set_reserve(struct clause_set* set, size_t count, size_t num_lits);
+
+// Read a \c long \c long at the cursor and return true on success,
+// false on error. Requires the cursor to be positioned immediately
+// at the ASCII integer. Set #errno when false is returned.
+//
+// #ERANGE: If the ASCII integer is too large.
+// #EILSEQ: If the cursor does not point to a digit or a minus
+//   followed by a digit.
+static bool read_long_long(struct cursor* cur, long long* result);
+
+// Skip non-newline whitespace at the cursor.
+static void skip_whitespace(struct cursor* cur);
+
+// Skip a specific character if it is the character at the cursor, where
+// #EOF matches the end of the input. Return true if the character was
+// skipped, false if not.
+static bool skip_char(struct cursor* cur, int c);
+
+// Skip the remaining characters of the line and its newline.
+static void skip_line(struct cursor* cur);
+
+// Match the specified text at the cursor and skip it if it matches.
+static bool match_token(struct cursor* cur, const char* str);
+
+// The value assigned to a variable during the search.
+enum value
+{
+  value_false,
+  value_true,
+  value_unset,
+};
+
+// A clause that watches a literal, and a blocker literal of the clause.
+// If the blocker is true, the clause is satisfied and the propagation
+// skips it without reading the clause from the arena.
+struct watcher
+{
+  uint32_t ref;
+  uint32_t blocker;
+};
+
+// The list of clauses that watch a literal, in one contiguous array.
+// Every clause with at least three literals watches its first two
+// literals, and it is only visited when one of them becomes false.
+struct watch_list
+{
+  size_t count;
+  size_t capacity;
+  struct watcher* watchers;
+};
+
+// The other literals of the binary clauses that contain a literal. When
+// the literal becomes false, these literals are implied.
+struct implication_list
+{
+  size_t count;
+  size_t capacity;
+  uint32_t* lits;
+};
+
+// The flags of a clause in the arena.
+enum clause_flag
+{
+  // The clause was learned from a conflict.
+  clause_flag_learnt = 1,
+
+  // The clause must never be deleted, ie. it blocks a solution that
+  // has already been found.
+  clause_flag_permanent = 2,
+
+  // The clause took part in a conflict since the last reduction.
+  clause_flag_used = 4,
+
+  // The clause is deleted by the running reduction.
+  clause_flag_deleted = 8,
+};
+
+// The header of a clause in solver#arena. It is directly followed by
+// the literals of the clause.
+struct clause_header
+{
+  // The number of literals.
+  uint32_t size;
+
+  // A combination of clause_flag values and the literal block distance
+  // of a learned clause, shifted by #clause_lbd_shift.
+  uint32_t flags;
+
+  // The activity of a learned clause, bumped when it takes part in a
+  // conflict.
+  float activity;
+};
+
+// Hint the processor to load the cache line at the address.
+#ifdef __GNUC__
+  #define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+  #define PREFETCH(addr) ((void) 0)
+#endif
+
+// The number of 32-bit words of a clause_header.
+#define CLAUSE_HEADER_WORDS (sizeof(struct clause_header) / sizeof(uint32_t))
+
+// Access the memory that the solvers of a portfolio share. Without
+// pthreads a portfolio has a single solver and plain accesses suffice.
+#ifndef _MSC_VER
+  #define SHARED_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+  #define SHARED_LOAD_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+  #define SHARED_STORE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+  #define SHARED_STORE_RELEASE(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+  #define SHARED_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+  #define SHARED_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+  #define SHARED_CLAIM(ptr, expected, value) \
+    __atomic_compare_exchange_n(ptr, &(expected), value, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+  #define SHARED_LOAD(ptr) (*(ptr))
+  #define SHARED_LOAD_ACQUIRE(ptr) (*(ptr))
+  #define SHARED_STORE(ptr, value) (*(ptr) = (value))
+  #define SHARED_STORE_RELEASE(ptr, value) (*(ptr) = (value))
+  #define SHARED_FENCE_ACQUIRE() ((void) 0)
+  #define SHARED_FENCE_RELEASE() ((void) 0)
+  #define SHARED_CLAIM(ptr, expected, value) \
+    (*(ptr) == (expected) ? (*(ptr) = (value), 1) : 0)
+#endif
+
+// A solver of a portfolio, see portfolio_solve().
+struct portfolio_worker;
+
+// A learned clause that may be deleted by solver_reduce().
+struct reduce_candidate
+{
+  float activity;
+  uint32_t ref;
+};
+
+// The state of the unit propagation engine.
+struct solver
+{
+  // The number of variables in the clause_set that is being solved.
+  size_t num_vars;
+
+  // An array of 2 * #num_vars values, one for each literal. The values
+  // of a literal and its negation are updated together.
+  unsigned char* values;
+
+  // An array of 2 * #num_vars watch lists, one for each literal.
+  // The watch lists contain clause references, see solver_clause().
+  struct watch_list* watches;
+
+  // An array of 2 * #num_vars implication lists, one for each literal.
+  // Binary clauses are only stored here, not in #arena and the watch
+  // lists, and they are propagated before the longer clauses.
+  struct implication_list* binaries;
+
+  // All clauses with at least two literals, stored as a clause_header
+  // followed by the literals. A clause is referenced by the offset of
+  // its header in 32-bit words. The clauses of the clause_set come
+  // first and the learned clauses start at #learnts_begin.
+  uint32_t* arena;
+  size_t arena_count;
+  size_t arena_capacity;
+  size_t learnts_begin;
+
+  // The number of learned clauses in #arena.
+  size_t num_learnts;
+
+  // The amount by which the activity of a learned clause is bumped.
+  double clause_inc;
+
+  // The number of conflicts at which the learned clauses are reduced
+  // next, the interval until the following reduction and the number
+  // of learned clauses that have been deleted.
+  size_t reduce_next;
+  size_t reduce_interval;
+  size_t num_deleted;
+
+  // The trail of literals that have been assigned true, in the order
+  // of their assignment. The literals starting at #trail_head have not
+  // yet been propagated through the watch lists, and the literals
+  // starting at #binary_head not through the binary clauses. The binary
+  // clauses are always ahead, #binary_head is never below #trail_head.
+  uint32_t* trail;
+  size_t trail_count;
+  size_t trail_head;
+  size_t binary_head;
+
+  // The decision levels. An array of #num_levels positions in #trail
+  // at which the decision literal of the respective level was pushed.
+  // Literals before the first decision are on level 0.
+  size_t* trail_lim;
+  size_t num_levels;
+
+  // Two arrays of #num_vars values with the decision level on which
+  // each variable was assigned, and the clause that implied it. The
+  // first literal of the reason clause is the implied literal. If the
+  // reason is #binary_clause, #reason_lits holds the other literal of
+  // the binary clause.
+  size_t* levels;
+  uint32_t* reasons;
+  uint32_t* reason_lits;
+
+  // The literals of the binary clause that became empty if
+  // solver_propagate() returned #binary_clause.
+  uint32_t conflict_lits[2];
+
+  // Scratch buffers for the conflict analysis: marks for the variables
+  // that have been visited, and the literals of the learned clause.
+  bool* seen;
+  uint32_t* learnt;
+
+  // Scratch buffers for the minimization of the learned clause: the
+  // depth first search stack of solver_redundant() and the literals
+  // whose variables have been marked in #seen.
+  uint32_t* analyze_stack;
+  uint32_t* analyze_toclear;
+  size_t toclear_count;
+
+  // An array of #num_vars activities. The activity of a variable is
+  // bumped by #var_inc when it takes part in a conflict. Instead of
+  // decaying all activities, #var_inc grows after each conflict.
+  double* activity;
+  double var_inc;
+
+  // A binary max-heap of variables ordered by their activity, which
+  // contains at least all unassigned variables. #heap_index holds the
+  // position of each variable in #heap, or #not_in_heap.
+  size_t* heap;
+  size_t heap_count;
+  size_t* heap_index;
+
+  // An array of #num_vars saved phases. A variable is assigned its
+  // saved phase when it is picked for a decision, and with phase saving
+  // the phase is updated to the value the variable had when it is
+  // unassigned.
+  bool* phases;
+
+  // An array of #num_vars target phases: the values of the longest
+  // conflict free trail seen since the last rephasing, which has
+  // #target_size literals. Every options#rephase_interval conflicts,
+  // the saved phases are reset to the target phases.
+  bool* target_phases;
+  size_t target_size;
+  size_t rephase_next;
+
+  // The number of conflicts and decisions so far.
+  size_t num_conflicts;
+  size_t num_decisions;
+
+  // The number of literals of the learned clauses before minimization,
+  // and the number of them removed by minimization.
+  size_t num_learned_lits;
+  size_t num_minimized_lits;
+
+  // The number of literals assigned by solver_probe() because they
+  // failed or were implied by both literals of a variable, and the
+  // number of hyper-binary resolvents it added.
+  size_t num_failed_lits;
+  size_t num_implied_lits;
+  size_t num_hyper_binaries;
+
+  // The number of clauses added from the other solvers of a portfolio.
+  size_t num_imported;
+
+  // The options passed to clause_set_solve().
+  struct clause_set_solve_options const* options;
+
+  // The simplifier that removed variables from the clause_set, or NULL.
+  // The eliminated variables are never decided on.
+  struct simplifier const* simplifier;
+
+  // The solver's place in a portfolio, or NULL if it runs alone.
+  struct portfolio_worker* worker;
+
+  // The number of restarts so far, and the number of conflicts since
+  // the last restart.
+  size_t num_restarts;
+  size_t restart_conflicts;
+
+  // The LBDs of the last options#glucose_window learned clauses in a
+  // ring buffer, their sum and the sum of the LBDs of all learned
+  // clauses.
+  size_t* lbd_window;
+  size_t lbd_window_count;
+  size_t lbd_window_pos;
+  size_t lbd_window_sum;
+  double lbd_sum;
+
+  // An array of #num_vars + 1 stamps, one for each decision level,
+  // used to count the distinct levels in a clause.
+  size_t* level_stamps;
+  size_t stamp;
+
+  // Set if the clause_set contains an empty clause or conflicting
+  // unit clauses, or if the search found a conflict on level 0.
+  bool unsat;
+
+  // Set if a memory error occured during the search.
+  bool oom;
+};
+
+// Return the zero based index of the variable of a literal.
+static size_t lit_var(uint32_t lit);
+
+// Return the negation of a literal.
+static uint32_t lit_neg(uint32_t lit);
+
+// Return true if the literal is not negated.
+static bool lit_positive(uint32_t lit);
+
+// Return the value of a literal under the current assignment.
+static enum value solver_lit_value(struct solver* solver, uint32_t lit);
+
+// Initialize the solver for the specified clause_set and options, copy
+// the clauses into the arena, set up the watch lists and assign the
+// unit clauses. \p simplifier may be NULL. Return false on a memory
+// error. The solver must be freed with solver_free() in any case.
+static bool solver_init(
+  struct solver* solver, struct clause_set* set,
+  struct clause_set_solve_options const* options,
+  struct simplifier const* simplifier);
+
+// Free the memory allocated by the solver.
+static void solver_free(struct solver* solver);
+
+// Return the header of the clause with the specified reference.
+static struct clause_header* solver_clause(struct solver* solver, uint32_t ref);
+
+// Return the literals of a clause in the arena.
+static uint32_t* clause_lits(struct clause_header* clause);
+
+// Return the LBD of a clause in the arena.
+static size_t clause_lbd(struct clause_header* clause);
+
+// Append a clause of \p count literals with the specified flags to the
+// arena and return its reference, or #no_clause on a memory error. The
+// literals must be filled in by the caller.
+static uint32_t solver_alloc_clause(
+  struct solver* solver, size_t count, uint32_t flags);
+
+// Add the clause with the specified reference to the watch list of
+// \p lit with another literal of the clause as the blocker. Return
+// false on a memory error.
+static bool solver_watch(
+  struct solver* solver, uint32_t lit, uint32_t ref, uint32_t blocker);
+
+// Add the binary clause of the two literals to their implication lists.
+// Return false on a memory error.
+static bool solver_add_binary(struct solver* solver, uint32_t a, uint32_t b);
+
+// Return true if the binary clause of the two literals exists.
+static bool solver_has_binary(struct solver* solver, uint32_t a, uint32_t b);
+
+// Return the literals of the clause \p ref that is the reason of \p
+// lit, or that became empty if \p lit is #no_lit, and store their
+// number in \p size. The literals of a binary clause are stored in \p
+// pair, without touching the arena.
+static uint32_t const* solver_reason_lits(
+  struct solver* solver, uint32_t ref, uint32_t lit, uint32_t* pair, size_t* size);
+
+// Assign true to the specified literal on the current decision level
+// with the specified reason clause and push it on the trail. Return
+// false if the literal is already false.
+static bool solver_assign(struct solver* solver, uint32_t lit, uint32_t reason);
+
+// Assign true to the specified unassigned literal, implied by the
+// binary clause with the false literal \p other.
+static void solver_assign_binary(struct solver* solver, uint32_t lit, uint32_t other);
+
+// Open a new decision level and assign true to the specified
+// unassigned literal.
+static void solver_decide(struct solver* solver, uint32_t lit);
+
+// Propagate all literals on the trail that have not been propagated
+// yet. The binary clauses of all assigned literals are propagated
+// first, then the clauses that watch a literal that became false are
+// visited. Return the reference of a clause that became empty, which
+// is #binary_clause for a binary clause, or #no_clause if there was no
+// conflict. A memory error is reported as a conflict, check
+// solver#oom.
+static uint32_t solver_propagate(struct solver* solver);
+
+// Unassign the literals of all decision levels above \p level. This
+// only touches the literals that were assigned on these levels. The
+// unassigned variables are put back into the heap.
+static void solver_backtrack(struct solver* solver, size_t level);
+
+// Move the variable at the specified heap position up or down until
+// the heap property is restored.
+static void solver_heap_up(struct solver* solver, size_t pos);
+static void solver_heap_down(struct solver* solver, size_t pos);
+
+// Insert a variable into the heap if it is not already in it.
+static void solver_heap_insert(struct solver* solver, size_t var);
+
+// Remove and return the variable with the highest activity.
+static size_t solver_heap_pop(struct solver* solver);
+
+// Increase the activity of a variable by solver#var_inc.
+static void solver_bump(struct solver* solver, size_t var);
+
+// Decay the activities of all variables and learned clauses, relative
+// to future bumps.
+static void solver_decay(struct solver* solver);
+
+// Return the unassigned variable with the highest activity, or
+// solver#num_vars if all variables are assigned.
+static size_t solver_pick(struct solver* solver);
+
+// Return the literal of the variable that has its saved phase.
+static uint32_t solver_phase_lit(struct solver* solver, size_t var);
+
+// Save the values of the trail below the current decision level as
+// the target phases if that part of the trail is the longest seen
+// since the last rephasing. Call on a conflict.
+static void solver_update_target(struct solver* solver);
+
+// Reset the saved phases to the target phases.
+static void solver_rephase(struct solver* solver);
+
+// Analyze the conflict in the specified clause and derive the first
+// unique implication point clause into solver#learnt. The asserting
+// literal is placed first and a literal of the backjump level second.
+// Return the number of literals and set \p out_level to the level to
+// backjump to.
+static size_t solver_analyze(
+  struct solver* solver, uint32_t conflict, size_t* out_level);
+
+// Return true if the false literal \p lit of the learned clause is
+// implied by the other literals of the clause, that is, every path
+// through the reasons of the assignments from \p lit ends in a literal
+// of the clause or on level 0. Decisions, and levels that are not in
+// the bit set \p abstract of solver_abstract_level() of the levels of
+// the clause, end the search early.
+static bool solver_redundant(struct solver* solver, uint32_t lit, uint32_t abstract);
+
+// Return a bit that stands for the decision level of a variable, so
+// that a set of levels fits in 32 bits.
+static uint32_t solver_abstract_level(struct solver* solver, size_t var);
+
+// Remove the redundant literals from the learned clause of \p count
+// literals in solver#learnt, whose variables are marked in
+// solver#seen. Return the new number of literals.
+static size_t solver_minimize(struct solver* solver, size_t count);
+
+// Remove the literals from the learned clause of \p count literals that
+// are implied by the asserting literal through a binary clause. Return
+// the new number of literals.
+static size_t solver_minimize_binary(struct solver* solver, size_t count);
+
+// Add a clause of \p count literals that is unit under the current
+// assignment with its first literal unassigned, and assign that
+// literal. The second literal must be of the highest decision level
+// among the others. Return false on a memory error.
+static bool solver_learn(
+  struct solver* solver, uint32_t* lits, size_t count, size_t lbd,
+  bool permanent);
+
+// Bump the activity of the clause with the specified reference and
+// update its LBD if it is a learned clause.
+static void solver_bump_clause(struct solver* solver, uint32_t ref);
+
+// Return true if the clause with the specified reference is the
+// reason of an assigned literal.
+static bool solver_locked(struct solver* solver, uint32_t ref);
+
+// Delete learned clauses that are unlikely to be useful again. Glue
+// clauses are kept, clauses with an LBD up to options#tier2_lbd are
+// kept if they have been used since the last reduction, and half of
+// the others are deleted by their activity. The remaining learned
+// clauses are moved together in the arena and all references to them
+// are updated.
+static void solver_reduce(struct solver* solver);
+
+// Return the new reference of a learned clause that was moved by
+// solver_reduce(), or #no_clause if it was deleted. \p from and \p to
+// are the sorted old and new references of the \p count moved clauses.
+static uint32_t relocate(
+  uint32_t ref, uint32_t const* from, uint32_t const* to, size_t count);
+
+// Compare two reduce_candidate structures by their activity.
+static int compare_reduce_candidates(const void* a, const void* b);
+
+// Return the number of distinct decision levels of the literals
+// (literal block distance).
+static size_t solver_lbd(struct solver* solver, uint32_t const* lits, size_t count);
+
+// The same for the literals of a clause in the arena.
+static size_t solver_clause_lbd(struct solver* solver, struct clause_header* clause);
+
+// Record the LBD of a learned clause for the restart policy.
+static void solver_record_lbd(struct solver* solver, size_t lbd);
+
+// Return true if the restart policy in solver#options asks for a
+// restart.
+static bool solver_should_restart(struct solver* solver);
+
+// Return the element with the specified index of the Luby sequence
+// 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+static size_t luby(size_t index);
+
+// Conflict driven clause learning search with non-chronological
+// backjumping. After a solution was passed to the callback, a clause
+// that blocks the decisions which led to it is added.
+static void solver_search(
+  struct solver* solver, bool* out_values,
+  clause_set_solve_callback callback, void* userdata, bool* sat);
+
+// Plain DPLL search with chronological backtracking, without learning.
+// The decisions on the trail are the search stack: the decision of the
+// deepest level is undone after a conflict or a solution, and its
+// negation is assigned on the level below as the second branch.
+static void solver_dpll(
+  struct solver* solver, bool* out_values,
+  clause_set_solve_callback callback, void* userdata, bool* sat);
+
+// Store the current assignment in \p out_values, extended to the
+// variables eliminated by the simplifier.
+static void solver_model(struct solver* solver, bool* out_values);
+
+// Probe the variables with binary clauses on the first decision level
+// before the search, until options#probe_budget literals have been
+// assigned. The negation of a literal whose propagation fails and the
+// literals implied by both literals of a variable are assigned on
+// level 0, and the hyper-binary resolvents of the probes are added.
+// Set solver#unsat if a conflict on level 0 follows.
+static void solver_probe(struct solver* solver);
+
+// Assign the literal on a new decision level and propagate it. Return
+// false on a conflict. Otherwise subtract the number of assigned
+// literals from \p budget and store the hyper-binary resolvents in
+// \p resolvents, two literals each. The decision level is left open.
+//
+// The literals implied by binary clauses form a tree rooted at the
+// probe, with their parents in \p parents and their trail positions in
+// \p positions, both indexed by variable. A literal implied by a longer
+// clause with at least two literals that are false on the probe's level
+// is implied by the dominator of their negations in the tree as well,
+// and the binary clause of the negated dominator and the literal is a
+// resolvent. The dominator becomes the literal's parent.
+static bool solver_probe_lit(
+  struct solver* solver, uint32_t lit, size_t* budget,
+  uint32_t* resolvents, size_t* num_resolvents,
+  uint32_t* parents, uint32_t* positions);
+
+// After backtracking from a probe, assign the negation of a failed
+// literal, or add the hyper-binary resolvents of a successful one that
+// are not binary clauses yet, at most #probe_hbr_limit per variable in
+// total, and propagate on level 0. Return false on a conflict or memory
+// error.
+static bool solver_probe_learn(
+  struct solver* solver, uint32_t lit, uint32_t const* resolvents,
+  size_t num_resolvents, bool failed);
+
+// Store the statistics of the search in \p stats.
+static void solver_store_stats(
+  struct solver const* solver, struct clause_set_solve_stats* stats);
+
+// Shuffle the order of the first decisions with small random activities
+// derived from \p seed, and start with negative phases if \p seed is
+// odd. Used to diversify the solvers of a portfolio.
+static void solver_diversify(struct solver* solver, size_t seed);
+
+// Publish a learned clause to the other solvers of the portfolio if it
+// is short enough, see #share_size_limit.
+static void solver_export(
+  struct solver* solver, uint32_t const* lits, size_t count, size_t lbd);
+
+// Add the clauses that the other solvers of the portfolio published
+// since the last call. Must be called on level 0. Return true if a
+// clause was added, and set solver#unsat if one of them is empty under
+// the assignment.
+static bool solver_import(struct solver* solver);
+
+// A ring buffer through which a solver of a portfolio publishes clauses
+// to the other solvers. Only the owner writes, every other solver reads
+// from a position of its own. A clause is stored as its size, its LBD
+// and its literals. #head is the number of words written so far, and
+// #reserved the number of words written once the clause that is being
+// stored is complete. A reader discards what it read if #reserved shows
+// that the words may have been overwritten meanwhile, and continues at
+// #head.
+struct share_ring
+{
+  uint32_t* words;
+  size_t head;
+  size_t reserved;
+};
+
+// A solver of a portfolio with its own thread, options and results.
+struct portfolio_worker
+{
+  struct portfolio* portfolio;
+  size_t index;
+
+  // The options of the solver, diversified by #index.
+  struct clause_set_solve_options options;
+  struct solver solver;
+
+  // Set once the solver is initialized, see portfolio_prepare().
+  bool prepared;
+
+  // The solution found by the solver, and whether it was found.
+  bool* values;
+  bool sat;
+
+  // The clauses published by the solver, the position up to which the
+  // ring of each solver has been read, and a buffer for the literals
+  // of a clause that is being imported.
+  struct share_ring ring;
+  size_t* positions;
+  uint32_t* import;
+};
+
+// Solvers with different heuristics that search the same clauses in
+// parallel, each on a thread of its own. The clauses are only read.
+struct portfolio
+{
+  struct clause_set* clauses;
+  struct simplifier const* simplifier;
+  struct portfolio_worker* workers;
+  size_t num_workers;
+
+  // The literals that the first solver assigned on level 0 before the
+  // search, followed by the two literals of each hyper-binary resolvent
+  // it added while probing. The other solvers start with them instead
+  // of probing the same clauses again.
+  uint32_t* probed;
+  size_t num_probed_units;
+  size_t num_probed_binaries;
+
+  // The index of the solver that found a solution or proved that there
+  // is none first, or #num_workers while the search is running. The
+  // other solvers stop when it is set.
+  size_t winner;
+};
+
+// Search the clauses with \p num_workers solvers in parallel, which
+// share their short learned clauses. The first solver that finishes
+// stops the others, its solution is stored in \p out_values and its
+// statistics in options#stats, and \p sat is set if it found one.
+// Return false if every solver failed with a memory error.
+static bool portfolio_solve(
+  struct clause_set* clauses, struct clause_set_solve_options const* options,
+  struct simplifier const* simplifier, size_t num_workers,
+  bool* out_values, bool* sat);
+
+// Initialize the solver of a portfolio_worker and propagate on level 0.
+// The first solver probes and records its results in
+// portfolio#probed, the others add these results. Return false on a
+// memory error.
+static bool portfolio_prepare(struct portfolio_worker* worker);
+
+// Run the solver of a portfolio_worker, the entry point of its thread.
+static void* portfolio_thread(void* worker);
+
+// The clauses of a simplifier that contain a literal, by their index.
+// Removed clauses are only dropped when the list is visited.
+struct occurrence_list
+{
+  size_t count;
+  size_t capacity;
+  uint32_t* clauses;
+};
+
+// A clause of a simplifier, its literals start at #offset in
+// simplifier#lits. The signature has the bit of every variable of the
+// clause modulo 64 set, see simplifier_signature().
+struct simplifier_clause
+{
+  size_t offset;
+  uint64_t signature;
+  uint32_t size;
+  bool removed;
+  bool queued;
+};
+
+// A literal whose successors in the binary implication graph are
+// visited by simplifier_substitute(), and the position of the next
+// clause in its occurrence list.
+struct tarjan_frame
+{
+  uint32_t lit;
+  size_t edge;
+};
+
+// The state of the preprocessing that runs before the search. It
+// removes subsumed clauses and strengthens clauses by self-subsuming
+// resolution, replaces equivalent literals by one representative, and
+// eliminates variables by clause distribution, smallest number of
+// resolution pairs first, as long as that does not add clauses. The
+// clauses that are removed with a variable are saved on a stack to
+// extend a model of the remaining clauses to the removed variables.
+struct simplifier
+{
+  // The number of variables in the clause_set.
+  size_t num_vars;
+
+  // The options passed to clause_set_solve().
+  struct clause_set_solve_options const* options;
+
+  // The clauses and their literals. Resolvents are appended, removed
+  // clauses stay in place.
+  struct simplifier_clause* clauses;
+  size_t count;
+  size_t capacity;
+  uint32_t* lits;
+  size_t num_lits;
+  size_t lits_capacity;
+
+  // Two arrays of 2 * #num_vars occurrence lists and the number of
+  // clauses in each list that have not been removed.
+  struct occurrence_list* occs;
+  size_t* num_occs;
+
+  // The clauses that are checked for clauses they subsume or strengthen:
+  // new clauses and clauses that lost a literal.
+  uint32_t* queue;
+  size_t queue_count;
+  size_t queue_capacity;
+
+  // The number of clauses removed by subsumption and the number of
+  // literals removed by self-subsuming resolution.
+  size_t num_subsumed;
+  size_t num_strengthened;
+
+  // The variables that may have become pure because the last
+  // occurrence of one of their literals was removed, and the number of
+  // pure literals that have been assigned.
+  uint32_t* pure;
+  size_t pure_count;
+  size_t pure_capacity;
+  size_t num_pure;
+
+  // An array of 2 * #num_vars values of the literals that have been
+  // assigned by unit clauses. These literals are stored in #units, the
+  // ones starting at #units_head have not been propagated yet.
+  unsigned char* values;
+  uint32_t* units;
+  size_t units_count;
+  size_t units_head;
+
+  // An array of #num_vars flags for the variables that have been
+  // removed from the clauses by elimination or substitution, and the
+  // number of variables removed by either.
+  bool* eliminated;
+  size_t num_eliminated;
+  size_t num_substituted;
+
+  // A binary min-heap of the variables that are candidates for the
+  // elimination, ordered by simplifier_cost(). #heap_index holds the
+  // position of each variable in #heap, or #not_in_heap.
+  size_t* heap;
+  size_t heap_count;
+  size_t* heap_index;
+
+  // Scratch buffers: an array of 2 * #num_vars marks for the literals
+  // and the literals of the last resolvent.
+  bool* marks;
+  uint32_t* resolvent;
+
+  // The reconstruction stack. Every saved clause is pushed as its
+  // witness literal, its other literals and its number of literals.
+  uint32_t* stack;
+  size_t stack_count;
+  size_t stack_capacity;
+
+  // Set if the clauses are unsatisfiable.
+  bool unsat;
+
+  // Set if a memory error occured.
+  bool oom;
+};
+
+// Initialize the simplifier with the clauses of the clause_set. Drop
+// tautologies and duplicate literals, and assign the unit clauses.
+// Return false on a memory error. The simplifier must be freed with
+// simplifier_free() in any case.
+static bool simplifier_init(
+  struct simplifier* simp, struct clause_set const* set,
+  struct clause_set_solve_options const* options);
+
+// Free the memory allocated by the simplifier.
+static void simplifier_free(struct simplifier* simp);
+
+// Add a clause without duplicate literals or tautologies. False
+// literals are left out, satisfied clauses are dropped and unit
+// clauses are assigned. Return false on a memory error.
+static bool simplifier_add_clause(
+  struct simplifier* simp, uint32_t const* lits, size_t count);
+
+// Mark the clause with the specified index as removed.
+static void simplifier_remove_clause(struct simplifier* simp, uint32_t index);
+
+// Remove the literal from the clause with the specified index. The
+// clause stays in the occurrence list of the literal. A clause that
+// becomes unit is removed and its literal assigned.
+static void simplifier_strengthen(struct simplifier* simp, uint32_t index, uint32_t lit);
+
+// Remove the clause with the specified index from the occurrence list
+// of the literal.
+static void simplifier_unlink(struct simplifier* simp, uint32_t index, uint32_t lit);
+
+// Return the signature of the literals of a clause.
+static uint64_t simplifier_signature(uint32_t const* lits, size_t size);
+
+// Queue the clause for simplifier_subsume_all() if subsumption is
+// enabled. Return false on a memory error.
+static bool simplifier_queue(struct simplifier* simp, uint32_t index);
+
+// Check the queued clauses until the queue is empty.
+static void simplifier_subsume_all(struct simplifier* simp);
+
+// Remove the clauses that are subsumed by the clause with the specified
+// index, and remove a literal from the clauses that contain its other
+// literals and the negation of one. The candidates are the clauses in
+// the shortest pair of occurrence lists of a variable of the clause.
+static void simplifier_subsume(struct simplifier* simp, uint32_t index);
+
+// Assign true to the literal. Set simplifier#unsat if it is false.
+static void simplifier_assign(struct simplifier* simp, uint32_t lit);
+
+// Remove the clauses satisfied by the assigned literals and the false
+// literals from the other clauses, until no unit clause is left.
+static void simplifier_propagate(struct simplifier* simp);
+
+// Run the simplifications enabled by the options until nothing is left
+// to do: subsumption first, then the substitution of equivalent
+// literals, then pure literals, then variable elimination followed by
+// the subsumption of the resolvents.
+static void simplifier_run(struct simplifier* simp);
+
+// Assign the pure literals, which occur in clauses while their negation
+// does not, and propagate them. The occurrence counts are kept up to
+// date as clauses are removed, thus only the variables queued in
+// simplifier#pure are checked again.
+static void simplifier_remove_pure(struct simplifier* simp);
+
+// Assign the literal of the variable if it is pure.
+static void simplifier_check_pure(struct simplifier* simp, size_t var);
+
+// Decrement the occurrence count of the literal. If it drops to zero,
+// queue its variable for simplifier_remove_pure().
+static void simplifier_drop_occ(struct simplifier* simp, uint32_t lit);
+
+// Find the strongly connected components of the binary implication
+// graph and replace the literals of each one by a representative.
+static void simplifier_substitute(struct simplifier* simp);
+
+// Eliminate the variable if the resolvents of its clauses are short and
+// do not outnumber them.
+static void simplifier_eliminate(struct simplifier* simp, size_t var);
+
+// Store the resolvent of the clauses with the indices \p a and \p b on
+// the variable in simplifier#resolvent and return its number of
+// literals, or #no_resolvent if it is a tautology.
+static size_t simplifier_resolve(
+  struct simplifier* simp, uint32_t a, uint32_t b, size_t var);
+
+// Push a clause that contains the witness literal on the
+// reconstruction stack. Return false on a memory error.
+static bool simplifier_push(
+  struct simplifier* simp, uint32_t const* lits, size_t size, uint32_t witness);
+
+// Store the remaining clauses and the assigned literals as unit
+// clauses in the empty clause_set. Return false on a memory error.
+static bool simplifier_extract(struct simplifier const* simp, struct clause_set* set);
+
+// Extend a model of the remaining clauses to the eliminated variables.
+static void simplifier_extend(struct simplifier const* simp, bool* values);
+
+// Return the number of resolution pairs of the variable, the order of
+// the candidates for the elimination.
+static size_t simplifier_cost(struct simplifier const* simp, size_t var);
+
+// Insert the variable into the heap of candidates, or restore its
+// position after its occurrences changed. Does nothing if variable
+// elimination is disabled.
+static void simplifier_touch(struct simplifier* simp, size_t var);
+
+// Move a variable up or down the heap until the heap is in order.
+static void simplifier_heap_up(struct simplifier* simp, size_t pos);
+static void simplifier_heap_down(struct simplifier* simp, size_t pos);
+
+// Remove and return the variable with the lowest cost.
+static size_t simplifier_heap_pop(struct simplifier* simp);
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+DPLL_THREAD_LOCAL char dpll_errinfo[BUFSIZ] = {0};
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void dpll_puterr(const char* fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(dpll_errinfo, BUFSIZ, fmt, args);
+  va_end(args);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+uint32_t lit_from_dimacs(long long dimacs)
+{
+  if (dimacs < 0)
+    return (uint32_t) (-dimacs - 1) * 2 + 1;
+  return (uint32_t) (dimacs - 1) * 2;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+long long lit_to_dimacs(uint32_t lit)
+{
+  long long const var = (long long) (lit >> 1) + 1;
+  return (lit & 1) ? -var : var;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_init(struct clause* clause)
+{
+  clause->count = 0;
+  clause->capacity = 0;
+  clause->vars = NULL;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_free(struct clause* clause)
+{
+  free(clause->vars);
+  clause_init(clause);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int clause_add(struct clause* clause, long long const var)
+{
+  // Check if the literal already exist.
+  size_t index;
+  for (index = 0; index < clause->count; ++index) {
+    if (clause->vars[index] == var)
+      return 1;
+  }
+
+  // Resize the data if necessary.
+  if (clause->count + 1 > clause->capacity) {
+    size_t new_capacity = (clause->capacity == 0 ? clause_chunksize : clause->capacity * 2);
+    long long* new_vars = realloc(clause->vars, sizeof(*new_vars) * new_capacity);
+    if (new_vars == NULL) {
+      clause_free(clause);
+      return -1;
+    }
+    clause->capacity = new_capacity;
+    clause->vars = new_vars;
+  }
+
+  clause->vars[clause->count] = var;
+  clause->count++;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_shrink_to_fit(struct clause* clause)
+{
+  assert(clause->count <= clause->capacity);
+  if (clause->count < clause->capacity) {
+    long long* new_vars = realloc(clause->vars, sizeof(*new_vars) * clause->count);
+    if (new_vars == NULL && clause->count > 0) {
+      clause_free(clause);
+      return false;
+    }
+    clause->capacity = clause->count;
+    clause->vars = new_vars;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_set_init(struct clause_set* set)
+{
+  set->num_vars = 0;
+  set->count = 0;
+  set->capacity = 0;
+  set->offsets = NULL;
+  set->num_lits = 0;
+  set->lits_capacity = 0;
+  set->lits = NULL;
+  set->map = NULL;
+  set->map_size = 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_set_free(struct clause_set* set)
+{
+  if (set->map) {
+#ifndef _MSC_VER
+    munmap(set->map, set->map_size);
+#endif
+  }
+  else {
+    free(set->offsets);
+    free(set->lits);
+  }
+  clause_set_init(set);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_add(struct clause_set* set, struct clause const* clause)
+{
+  size_t index;
+
+  if (!clause_set_reserve(set, 1, clause->count)) {
+    clause_set_free(set);
+    return false;
+  }
+
+  for (index = 0; index < clause->count; ++index) {
+    set->lits[set->num_lits++] = lit_from_dimacs(clause->vars[index]);
+  }
+  set->count++;
+  set->offsets[set->count] = set->num_lits;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool clause_set_append(struct clause_set* set, struct clause_set const* other)
+{
+  size_t index;
+
+  if (!clause_set_reserve(set, other->count, other->num_lits))
+    return false;
+  if (other->num_lits > 0)
+    memcpy(set->lits + set->num_lits, other->lits, sizeof(*other->lits) * other->num_lits);
+  for (index = 1; index <= other->count; ++index) {
+    set->offsets[set->count + index] = set->num_lits + other->offsets[index];
+  }
+  set->count += other->count;
+  set->num_lits += other->num_lits;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool clause_set_reserve(struct clause_set* set, size_t count, size_t num_lits)
+{
+  if (set->map && !clause_set_unshare(set))
+    return false;
+
+  // Reserve one more offset than clauses for the end of the last one.
+  if (set->count + count + 1 > set->capacity) {
+    size_t new_capacity = (set->capacity == 0 ? clause_set_chunksize : set->capacity * 2);
+    size_t* new_offsets;
+    if (new_capacity < set->count + count + 1)
+      new_capacity = set->count + count + 1;
+    new_offsets = realloc(set->offsets, sizeof(*new_offsets) * new_capacity);
+    if (new_offsets == NULL)
+      return false;
+    if (set->capacity == 0)
+      new_offsets[0] = 0;
+    set->capacity = new_capacity;
+    set->offsets = new_offsets;
+  }
+  if (set->num_lits + num_lits > set->lits_capacity) {
+    size_t new_capacity = (set->lits_capacity == 0 ?
+      clause_set_chunksize * clause_chunksize : set->lits_capacity * 2);
+    uint32_t* new_lits;
+    if (new_capacity < set->num_lits + num_lits)
+      new_capacity = set->num_lits + num_lits;
+    new_lits = realloc(set->lits, sizeof(*new_lits) * new_capacity);
+    if (new_lits == NULL)
+      return false;
+    set->lits_capacity = new_capacity;
+    set->lits = new_lits;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool clause_set_unshare(struct clause_set* set)
+{
+  size_t* offsets = malloc(sizeof(*offsets) * (set->count + 1));
+  uint32_t* lits = malloc(sizeof(*lits) * (set->num_lits > 0 ? set->num_lits : 1));
+  if (offsets == NULL || lits == NULL) {
+    free(offsets);
+    free(lits);
+    return false;
+  }
+  memcpy(offsets, set->offsets, sizeof(*offsets) * (set->count + 1));
+  if (set->num_lits > 0)
+    memcpy(lits, set->lits, sizeof(*lits) * set->num_lits);
+#ifndef _MSC_VER
+  munmap(set->map, set->map_size);
+#endif
+  set->map = NULL;
+  set->map_size = 0;
+  set->offsets = offsets;
+  set->lits = lits;
+  set->capacity = set->count + 1;
+  set->lits_capacity = (set->num_lits > 0 ? set->num_lits : 1);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_shrink_to_fit(struct clause_set* set)
+{
+  if (set->capacity > set->count + 1) {
+    size_t* new_offsets = realloc(set->offsets, sizeof(*new_offsets) * (set->count + 1));
+    if (new_offsets == NULL)
+      return false;
+    set->capacity = set->count + 1;
+    set->offsets = new_offsets;
+  }
+  if (set->lits_capacity > set->num_lits && set->num_lits > 0) {
+    uint32_t* new_lits = realloc(set->lits, sizeof(*new_lits) * set->num_lits);
+    if (new_lits == NULL)
+      return false;
+    set->lits_capacity = set->num_lits;
+    set->lits = new_lits;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_builder_init(struct clause_builder* builder, struct clause_set* set)
+{
+  builder->set = set;
+  builder->count = 0;
+  builder->stamps = NULL;
+  builder->num_stamps = 0;
+  builder->stamp = 1;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_builder_free(struct clause_builder* builder)
+{
+  free(builder->stamps);
+  builder->count = 0;
+  builder->stamps = NULL;
+  builder->num_stamps = 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int clause_builder_add(struct clause_builder* builder, long long const var)
+{
+  struct clause_set* set = builder->set;
+  uint32_t const lit = lit_from_dimacs(var);
+  uint32_t* lits;
+  size_t index;
+  int result = 0;
+
+  if (!clause_set_reserve(set, 1, builder->count + 1))
+    return -1;
+  lits = set->lits + set->num_lits;
+
+  // The literals of a short clause are still in the cache, comparing
+  // them is cheaper than a stamp lookup. Longer clauses switch to the
+  // stamps, all literals so far are stamped once.
+  if (builder->count < clause_builder_scan_limit) {
+    for (index = 0; index < builder->count; ++index) {
+      if (lits[index] == lit)
+        return 1;
+      if (lits[index] == (lit ^ 1))
+        result = 2;
+    }
+  }
+  else {
+    if (builder->count == clause_builder_scan_limit) {
+      for (index = 0; index < builder->count; ++index) {
+        if (!clause_builder_reserve(builder, lits[index]))
+          return -1;
+        builder->stamps[lits[index]] = builder->stamp;
+      }
+    }
+    if (!clause_builder_reserve(builder, lit))
+      return -1;
+    if (builder->stamps[lit] == builder->stamp)
+      return 1;
+    if (builder->stamps[lit ^ 1] == builder->stamp)
+      result = 2;
+    builder->stamps[lit] = builder->stamp;
+  }
+
+  lits[builder->count++] = lit;
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool clause_builder_reserve(struct clause_builder* builder, uint32_t lit)
+{
+  if ((size_t) (lit | 1) >= builder->num_stamps) {
+    size_t new_count = (builder->num_stamps == 0 ? 2 * clause_set_chunksize : builder->num_stamps * 2);
+    uint32_t* new_stamps;
+    if (new_count <= (size_t) (lit | 1))
+      new_count = (size_t) (lit | 1) + 1;
+    new_stamps = realloc(builder->stamps, sizeof(*new_stamps) * new_count);
+    if (new_stamps == NULL)
+      return false;
+    memset(new_stamps + builder->num_stamps, 0, sizeof(*new_stamps) * (new_count - builder->num_stamps));
+    builder->num_stamps = new_count;
+    builder->stamps = new_stamps;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_builder_end(struct clause_builder* builder)
+{
+  struct clause_set* set = builder->set;
+  if (!clause_set_reserve(set, 1, builder->count))
+    return false;
+  set->num_lits += builder->count;
+  set->count++;
+  set->offsets[set->count] = set->num_lits;
+  builder->count = 0;
+
+  // Start over when the stamps wrap around.
+  if (++builder->stamp == 0) {
+    if (builder->stamps)
+      memset(builder->stamps, 0, sizeof(*builder->stamps) * builder->num_stamps);
+    builder->stamp = 1;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_parse(struct clause_set* set, FILE* fp)
+{
+  return clause_set_parse_parallel(set, fp, 1);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_parse_parallel(
+  struct clause_set* set, FILE* fp, size_t num_threads)
+{
+  struct input input;
+  struct cursor cur;
+  unsigned char magic[INPUT_MAGIC_SIZE];
+  size_t magic_size;
+  enum input_format format;
+  off_t pos;
+  bool result;
+
+  if (num_threads == 0) {
+#ifndef _MSC_VER
+    long const online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = (online > 0 ? (size_t) online : 1);
+#else
+    num_threads = 1;
+#endif
+  }
+
+  // Detect the format from the first bytes. A seekable file is rewound
+  // afterwards, the bytes read from a pipe are passed on.
+  pos = ftello(fp);
+  magic_size = fread(magic, 1, sizeof(magic), fp);
+  format = input_detect(magic, magic_size);
+  if (format != input_plain)
+    return parse_compressed(set, fp, format, magic, magic_size);
+  if (pos >= 0 && fseeko(fp, pos, SEEK_SET) == 0)
+    magic_size = 0;
+
+  if (!input_load(&input, fp, magic, magic_size)) {
+    dpll_puterr("clause_set_parse(): could not read input");
+    return false;
+  }
+  cur.pos = input.data;
+  cur.end = input.data + input.size;
+  result = parse_dimacs(set, &cur, num_threads);
+  input_free(&input);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_parse_file(
+  struct clause_set* set, const char* path, size_t num_threads)
+{
+  FILE* fp;
+  bool result;
+
+  if (path == NULL || strcmp(path, "-") == 0)
+    return clause_set_parse_parallel(set, stdin, num_threads);
+
+  fp = fopen(path, "rb");
+  if (fp == NULL) {
+    dpll_puterr("clause_set_parse(): could not open '%s'", path);
+    return false;
+  }
+  result = clause_set_parse_parallel(set, fp, num_threads);
+  fclose(fp);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool parse_header(
+  struct clause_set* set, struct cursor* cur, long long* num_vars)
+{
+  long long num_clauses;
+
+  // Skip all comment lines.
+  while (skip_char(cur, 'c'))
+    skip_line(cur);
+
+  // Read the pre conditions.
+  if (!skip_char(cur, 'p')) {
+    dpll_puterr("clause_set_parse(): expected 'p' instruction");
+    return false;
+  }
+  skip_whitespace(cur);
+  if (!match_token(cur, "cnf")) {
+    dpll_puterr("clause_set_parse(): expected 'cnf' token");
+    return false;
+  }
+  skip_whitespace(cur);
+  if (!read_long_long(cur, num_vars)) {
+    dpll_puterr("clause_set_parse(): expected num vars");
+    return false;
+  }
+  skip_whitespace(cur);
+  if (!read_long_long(cur, &num_clauses))
+    num_clauses = 0;
+
+  if (*num_vars < 0 || *num_vars > INT32_MAX) {
+    errno = EINVAL;
+    dpll_puterr("clause_set_parse(): literal count too big or not positive");
+    return false;
+  }
+  set->num_vars = (size_t) *num_vars;
+
+  skip_whitespace(cur);
+  if (!skip_char(cur, '\n')) {
+    // expected newline after number of literals.
+    errno = EINVAL;
+    dpll_puterr("clause_set_parse(): expected newline after 'p' instruction, got %c",
+      cur->pos < cur->end ? *cur->pos : EOF);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool header_complete(struct cursor const* cur)
+{
+  char const* pos = cur->pos;
+  while (pos < cur->end) {
+    char const* newline = memchr(pos, '\n', (size_t) (cur->end - pos));
+    if (newline == NULL)
+      return false;
+    if (*pos != 'c')
+      return true;
+    pos = newline + 1;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool parse_dimacs(
+  struct clause_set* set, struct cursor* cur, size_t num_threads)
+{
+  long long num_vars;
+  struct parse_chunk* chunks;
+  size_t num_chunks, index;
+  size_t base = set->count;
+  bool result = true;
+
+  if (!parse_header(set, cur, &num_vars))
+    return false;
+
+  // Every clause is on a line of its own, thus the clauses can be split
+  // into chunks after any newline.
+  num_chunks = (size_t) (cur->end - cur->pos) / parse_chunksize + 1;
+  if (num_chunks > num_threads)
+    num_chunks = num_threads;
+#ifdef _MSC_VER
+  num_chunks = 1;
+#endif
+  chunks = malloc(sizeof(*chunks) * num_chunks);
+  if (chunks == NULL) {
+    errno = ENOMEM;
+    dpll_puterr("clause_set_parse(): could not add new clause");
+    return false;
+  }
+  for (index = 0; index < num_chunks; ++index) {
+    struct parse_chunk* chunk = &chunks[index];
+    chunk->cur.pos = (index == 0 ? cur->pos : chunks[index - 1].cur.end);
+    chunk->cur.end = cur->end;
+    if (index + 1 < num_chunks) {
+      struct cursor split;
+      split.pos = cur->pos + (size_t) (cur->end - cur->pos) / num_chunks * (index + 1);
+      split.end = cur->end;
+      if (split.pos < chunk->cur.pos)
+        split.pos = chunk->cur.pos;
+      skip_line(&split);
+      chunk->cur.end = split.pos;
+    }
+    chunk->num_vars = num_vars;
+    clause_set_init(&chunk->local);
+    chunk->set = (num_chunks == 1 ? set : &chunk->local);
+    chunk->first = chunk->set->count;
+    chunk->error = parse_ok;
+    chunk->warning = false;
+  }
+
+  // Parse the first chunk on the calling thread.
+#ifndef _MSC_VER
+  {
+    pthread_t* threads = malloc(sizeof(*threads) * num_chunks);
+    bool* started = calloc(num_chunks, sizeof(*started));
+    if (threads && started) {
+      for (index = 1; index < num_chunks; ++index)
+        started[index] = pthread_create(&threads[index], NULL, parse_clauses_thread, &chunks[index]) == 0;
+    }
+    parse_clauses_thread(&chunks[0]);
+    for (index = 1; index < num_chunks; ++index) {
+      if (started && started[index])
+        pthread_join(threads[index], NULL);
+      else
+        parse_clauses_thread(&chunks[index]);
+    }
+    free(threads);
+    free(started);
+  }
+#else
+  parse_clauses_thread(&chunks[0]);
+#endif
+
+  // Report the first error, as the sequential parser would, and append
+  // the clauses in order.
+  for (index = 0; index < num_chunks; ++index) {
+    struct parse_chunk* chunk = &chunks[index];
+    if (result && !parse_report(chunk, base - chunk->first))
+      result = false;
+    if (result && chunk->set != set && !clause_set_append(set, chunk->set)) {
+      errno = ENOMEM;
+      dpll_puterr("clause_set_parse(): could not add new clause");
+      result = false;
+    }
+    base += chunk->set->count - chunk->first;
+    clause_set_free(&chunk->local);
+  }
+  free(chunks);
+
+  // Not releasing the unused capacity is no error.
+  if (result)
+    clause_set_shrink_to_fit(set);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void parse_clauses(struct parse_chunk* chunk, struct clause_builder* builder)
+{
+  struct cursor* cur = &chunk->cur;
+  struct clause_set* set = chunk->set;
+  long long const num_vars = chunk->num_vars;
+  long long value;
+  int res;
+
+  // Read a clause from each line straight into the clause_set. Since
+  // empty clauses don't make much sense in a CNF (as they evaluate to
+  // false), we simply skip empty lines.
+  while (cur->pos < cur->end) {
+    size_t const index = set->count;
+
+    skip_whitespace(cur);
+    if (skip_char(cur, '\n') || skip_char(cur, EOF))
+      continue;
+
+    while (true) {
+      skip_whitespace(cur);
+      if (skip_char(cur, '0')) {
+        skip_whitespace(cur);
+        if (!skip_char(cur, '\n')) {
+          chunk->error = parse_error_terminator;
+          chunk->error_index = index;
+          return;
+        }
+        break;
+      }
+
+      if (!read_long_long(cur, &value)) {
+        chunk->error = parse_error_literal;
+        chunk->error_index = index;
+        return;
+      }
+
+      if (value < -num_vars || value > num_vars || value == 0) {
+        chunk->error = parse_error_range;
+        chunk->error_index = index;
+        chunk->error_value = value;
+        return;
+      }
+
+      // Tautologies (res == 2) are kept like any other clause.
+      res = clause_builder_add(builder, value);
+      if (res == -1) {
+        chunk->error = parse_error_add_literal;
+        return;
+      }
+      else if (res == 1) {
+        chunk->warning = true;
+        chunk->warning_index = index;
+        chunk->warning_value = value;
+      }
+    }
+
+    if (!clause_builder_end(builder)) {
+      chunk->error = parse_error_add_clause;
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void* parse_clauses_thread(void* chunk)
+{
+  struct clause_builder builder;
+  clause_builder_init(&builder, ((struct parse_chunk*) chunk)->set);
+  parse_clauses(chunk, &builder);
+  clause_builder_free(&builder);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool parse_report(struct parse_chunk const* chunk, size_t base)
+{
+  size_t const index = base + chunk->error_index;
+  if (chunk->warning) {
+    dpll_puterr(
+      "clause_set_parse(): warning: clause #"PRsize_t": "
+      "contains duplicate literal '%llu'", base + chunk->warning_index, chunk->warning_value);
+  }
+  switch (chunk->error) {
+    case parse_ok:
+      return true;
+    case parse_error_terminator:
+      dpll_puterr("clause_set_parse(): clause #"PRsize_t": expected newline after clause terminator", index);
+      return false;
+    case parse_error_literal:
+      errno = EINVAL;
+      dpll_puterr("clause_set_parse(): clause #"PRsize_t": expected literal ", index);
+      return false;
+    case parse_error_range:
+      errno = EINVAL;
+      dpll_puterr(
+        "clause_set_parse(): clause #"PRsize_t": literal "
+        "'%llu' not in range", index, chunk->error_value);
+      return false;
+    case parse_error_add_literal:
+      errno = ENOMEM;
+      dpll_puterr("clause_set_parse(): could not add literal to clause");
+      return false;
+    case parse_error_add_clause:
+    default:
+      errno = ENOMEM;
+      dpll_puterr("clause_set_parse(): could not add new clause");
+      return false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_set_format(struct clause_set* set, FILE* fp)
+{
+  size_t index;
+  fprintf(fp, PRsize_t"\n", set->num_vars);
+  for (index = 0; index < set->count; ++index) {
+    size_t j;
+    for (j = set->offsets[index]; j < set->offsets[index + 1]; ++j) {
+      fprintf(fp, "%lld ", lit_to_dimacs(set->lits[j]));
+    }
+    fprintf(fp, "\n");
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_write_cache(
+  struct clause_set const* set, const char* path, const char* source)
+{
+  struct cache_header header;
+  uint64_t offset;
+  size_t index;
+  FILE* fp;
+  bool result;
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, cache_magic, sizeof(header.magic));
+  header.version = cache_version;
+  header.byte_order = cache_byte_order;
+  header.num_vars = set->num_vars;
+  header.count = set->count;
+  header.num_lits = set->num_lits;
+  if (source) {
+    struct stat st;
+    if (stat(source, &st) != 0) {
+      dpll_puterr("clause_set_write_cache(): could not stat '%s'", source);
+      return false;
+    }
+    header.source_size = (uint64_t) st.st_size;
+    header.source_mtime = (int64_t) st.st_mtime;
+  }
+
+  // The offsets are written as 64-bit values whatever the size of
+  // size_t, the checksum is taken over them in that form.
+  header.checksum = cache_checksum_basis;
+  for (index = 0; index <= set->count; ++index) {
+    offset = (set->offsets ? set->offsets[index] : 0);
+    header.checksum = cache_checksum(header.checksum, (uint32_t const*) &offset, 2);
+  }
+  header.checksum = cache_checksum(header.checksum, set->lits, set->num_lits);
+
+  fp = fopen(path, "wb");
+  if (fp == NULL) {
+    dpll_puterr("clause_set_write_cache(): could not open '%s'", path);
+    return false;
+  }
+  result = fwrite(&header, sizeof(header), 1, fp) == 1;
+  if (sizeof(size_t) == sizeof(uint64_t) && set->offsets) {
+    result = result && fwrite(set->offsets, sizeof(*set->offsets), set->count + 1, fp) == set->count + 1;
+  }
+  else {
+    for (index = 0; result && index <= set->count; ++index) {
+      offset = (set->offsets ? set->offsets[index] : 0);
+      result = fwrite(&offset, sizeof(offset), 1, fp) == 1;
+    }
+  }
+  if (set->num_lits > 0)
+    result = result && fwrite(set->lits, sizeof(*set->lits), set->num_lits, fp) == set->num_lits;
+  if (fclose(fp) != 0)
+    result = false;
+  if (!result) {
+    errno = EIO;
+    dpll_puterr("clause_set_write_cache(): could not write '%s'", path);
+    remove(path);
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_load_cache(
+  struct clause_set* set, const char* path, const char* source)
+{
+  struct cache_header header;
+  struct stat st;
+  uint64_t checksum = cache_checksum_basis;
+  uint64_t const* offsets;
+  uint32_t const* lits;
+  size_t size, index;
+  char* data = NULL;
+  bool valid;
+  FILE* fp;
+
+  fp = fopen(path, "rb");
+  if (fp == NULL) {
+    dpll_puterr("clause_set_load_cache(): could not open '%s'", path);
+    return false;
+  }
+  if (fstat(fileno(fp), &st) != 0 || fread(&header, sizeof(header), 1, fp) != 1 ||
+      memcmp(header.magic, cache_magic, sizeof(header.magic)) != 0 ||
+      header.version != cache_version || header.byte_order != cache_byte_order ||
+      header.num_vars > INT32_MAX || header.count >= SIZE_MAX / sizeof(uint64_t) ||
+      header.num_lits > SIZE_MAX / sizeof(uint32_t) ||
+      // Neither count can exceed the file, thus the size below can not
+      // overflow.
+      header.count >= (uint64_t) st.st_size / sizeof(uint64_t) ||
+      header.num_lits > (uint64_t) st.st_size / sizeof(uint32_t) ||
+      (uint64_t) st.st_size != sizeof(header) + (header.count + 1) * sizeof(uint64_t) +
+        header.num_lits * sizeof(uint32_t)) {
+    fclose(fp);
+    errno = EILSEQ;
+    dpll_puterr("clause_set_load_cache(): '%s' is not a cache", path);
+    return false;
+  }
+  if (source) {
+    struct stat source_st;
+    if (stat(source, &source_st) != 0 ||
+        header.source_size != (uint64_t) source_st.st_size ||
+        header.source_mtime != (int64_t) source_st.st_mtime) {
+      fclose(fp);
+      errno = ESTALE;
+      dpll_puterr("clause_set_load_cache(): '%s' is stale", path);
+      return false;
+    }
+  }
+
+  // Map the whole file. Without mmap(), it is read into memory.
+  size = (size_t) st.st_size;
+#ifndef _MSC_VER
+  {
+    void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (map != MAP_FAILED) {
+      posix_madvise(map, size, POSIX_MADV_WILLNEED);
+      set->map = map;
+      set->map_size = size;
+      data = map;
+    }
+  }
+#endif
+  if (data == NULL) {
+    data = malloc(size);
+    if (data == NULL || fseek(fp, 0, SEEK_SET) != 0 || fread(data, 1, size, fp) != size) {
+      free(data);
+      fclose(fp);
+      errno = EIO;
+      dpll_puterr("clause_set_load_cache(): could not read '%s'", path);
+      return false;
+    }
+  }
+  fclose(fp);
+
+  offsets = (uint64_t const*) (data + sizeof(header));
+  lits = (uint32_t const*) (offsets + header.count + 1);
+
+  // The offsets and literals are validated as well, the solver relies
+  // on them to index its arrays.
+  checksum = cache_checksum(checksum, (uint32_t const*) offsets, (size_t) (header.count + 1) * 2);
+  checksum = cache_checksum(checksum, lits, (size_t) header.num_lits);
+  valid = (checksum == header.checksum && offsets[0] == 0 && offsets[header.count] == header.num_lits);
+  for (index = 1; valid && index <= header.count; ++index)
+    valid = (offsets[index] >= offsets[index - 1]);
+  for (index = 0; valid && index < header.num_lits; ++index)
+    valid = (lits[index] < header.num_vars * 2);
+  if (!valid) {
+    if (set->map) {
+#ifndef _MSC_VER
+      munmap(set->map, set->map_size);
+#endif
+      set->map = NULL;
+      set->map_size = 0;
+    }
+    else {
+      free(data);
+    }
+    errno = EILSEQ;
+    dpll_puterr("clause_set_load_cache(): '%s' is corrupt", path);
+    return false;
+  }
+
+  set->num_vars = (size_t) header.num_vars;
+  set->count = (size_t) header.count;
+  set->capacity = set->count + 1;
+  set->num_lits = (size_t) header.num_lits;
+  set->lits_capacity = set->num_lits;
+  set->lits = (uint32_t*) lits;
+  if (set->map && sizeof(size_t) == sizeof(uint64_t)) {
+    set->offsets = (size_t*) offsets;
+    return true;
+  }
+
+  // Otherwise the offsets and literals are copied out of the data.
+  set->offsets = malloc(sizeof(*set->offsets) * set->capacity);
+  set->lits = malloc(sizeof(*set->lits) * (set->num_lits > 0 ? set->num_lits : 1));
+  if (set->offsets && set->lits) {
+    for (index = 0; index <= set->count; ++index)
+      set->offsets[index] = (size_t) offsets[index];
+    if (set->num_lits > 0)
+      memcpy(set->lits, lits, sizeof(*lits) * set->num_lits);
+  }
+  if (set->map) {
+#ifndef _MSC_VER
+    munmap(set->map, set->map_size);
+#endif
+    set->map = NULL;
+    set->map_size = 0;
+  }
+  else {
+    free(data);
+  }
+  if (set->offsets == NULL || set->lits == NULL) {
+    clause_set_free(set);
+    errno = ENOMEM;
+    dpll_puterr("clause_set_load_cache(): could not read '%s'", path);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint64_t cache_checksum(uint64_t hash, uint32_t const* words, size_t count)
+{
+  // FNV-1a on 32-bit words instead of bytes.
+  size_t index;
+  for (index = 0; index < count; ++index) {
+    hash ^= words[index];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+void clause_set_solve_options_init(struct clause_set_solve_options* options)
+{
+  options->mode = solve_mode_cdcl;
+  options->restarts = restarts_glucose;
+  options->luby_unit = 100;
+  options->glucose_window = 50;
+  options->glucose_factor = 0.8;
+  options->reduce_interval = 2000;
+  options->reduce_increment = 300;
+  options->tier2_lbd = 6;
+  options->phase_saving = true;
+  options->rephase_interval = 1000;
+  options->minimize = true;
+  options->minimize_binary = true;
+  options->stats = NULL;
+  options->eliminate = false;
+  options->subsume = true;
+  options->substitute = true;
+  options->pure = true;
+  options->probe_budget = 500000;
+  options->threads = 1;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+bool clause_set_solve(
+  struct clause_set* set, struct clause_set_solve_options const* options,
+  bool** out_values, clause_set_solve_callback callback, void* userdata)
+{
+  bool sat = false;
+  struct solver solver;
+  struct simplifier simplifier;
+  struct clause_set simplified;
+  struct clause_set* clauses = set;
+  bool simplify;
+  struct clause_set_solve_options effective_options;
+  size_t num_workers;
+
+  if (options == NULL)
+    clause_set_solve_options_init(&effective_options);
+  else
+    effective_options = *options;
+  options = &effective_options;
+
+  // A callback must see the solutions in which a pure literal is false.
+  if (callback)
+    effective_options.pure = false;
+
+  if (options->stats)
+    memset(options->stats, 0, sizeof(*options->stats));
+  simplify = options->subsume || options->substitute || options->pure || options->eliminate;
+
+  if (simplify) {
+    bool ok;
+    clause_set_init(&simplified);
+    ok = simplifier_init(&simplifier, set, options);
+    if (ok) {
+      simplifier_run(&simplifier);
+      ok = !simplifier.oom && simplifier_extract(&simplifier, &simplified);
+    }
+    if (!ok) {
+      clause_set_free(&simplified);
+      simplifier_free(&simplifier);
+      errno = ENOMEM;
+      return false;
+    }
+    clauses = &simplified;
+  }
+
+  // The portfolio only searches for the first solution, since the
+  // solvers do not know each other's blocking clauses.
+  num_workers = options->threads;
+  if (options->mode != solve_mode_cdcl || callback)
+    num_workers = 1;
+  if (num_workers == 0) {
+#ifndef _MSC_VER
+    long const online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_workers = (online > 0 ? (size_t) online : 1);
+#else
+    num_workers = 1;
+#endif
+  }
+#ifdef _MSC_VER
+  num_workers = 1;
+#endif
+
+  if (num_workers > 1) {
+    *out_values = malloc(sizeof(bool) * set->num_vars);
+    if (!*out_values || !portfolio_solve(clauses, options,
+        simplify ? &simplifier : NULL, num_workers, *out_values, &sat)) {
+      errno = ENOMEM;
+      sat = false;
+    }
+    if (simplify)
+      clause_set_free(&simplified);
+  }
+  else {
+    // The solver copies the clauses, the simplified ones can be freed
+    // right away.
+    bool const ok = solver_init(&solver, clauses, options, simplify ? &simplifier : NULL);
+    if (simplify)
+      clause_set_free(&simplified);
+    *out_values = ok ? malloc(sizeof(bool) * set->num_vars) : NULL;
+    if (!*out_values) {
+      solver_free(&solver);
+      if (simplify)
+        simplifier_free(&simplifier);
+      errno = ENOMEM;
+      return false;
+    }
+
+    // Propagate the unit clauses before the first decision.
+    if (!solver.unsat && solver_propagate(&solver) == no_clause) {
+      if (options->probe_budget > 0)
+        solver_probe(&solver);
+    }
+    else {
+      solver.unsat = true;
+    }
+    if (!solver.unsat && !solver.oom) {
+      if (options->mode == solve_mode_dpll)
+        solver_dpll(&solver, *out_values, callback, userdata, &sat);
+      else
+        solver_search(&solver, *out_values, callback, userdata, &sat);
+    }
+    if (solver.oom) {
+      errno = ENOMEM;
+      sat = false;
+    }
+    if (options->stats)
+      solver_store_stats(&solver, options->stats);
+    solver_free(&solver);
+  }
+
+  if (options->stats && simplify) {
+    options->stats->eliminated = simplifier.num_eliminated;
+    options->stats->substituted = simplifier.num_substituted;
+    options->stats->pure_lits = simplifier.num_pure;
+    options->stats->subsumed = simplifier.num_subsumed;
+    options->stats->strengthened = simplifier.num_strengthened;
+  }
+  if (simplify)
+    simplifier_free(&simplifier);
+  if (!sat) {
+    free(*out_values);
+    *out_values = NULL;
+  }
+  return sat;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_dpll(
+  struct solver* solver, bool* out_values,
+  clause_set_solve_callback callback, void* userdata, bool* sat)
+{
+  while (true) {
+    uint32_t const conflict = solver_propagate(solver);
+    uint32_t lit;
+    size_t var;
+
+    if (solver->oom)
+      return;
+
+    if (conflict != no_clause) {
+      uint32_t pair[2];
+      size_t size, index;
+      uint32_t const* lits = solver_reason_lits(solver, conflict, no_lit, pair, &size);
+      solver->num_conflicts++;
+      for (index = 0; index < size; ++index) {
+        solver_bump(solver, lit_var(lits[index]));
+      }
+      solver_decay(solver);
+    }
+    else {
+      var = solver_pick(solver);
+      if (var != solver->num_vars) {
+        solver_decide(solver, solver_phase_lit(solver, var));
+        continue;
+      }
+
+      // All variables are assigned and no clause is empty, thus every
+      // clause contains at least one true literal.
+      solver_model(solver, out_values);
+      *sat = true;
+      if (!callback || !callback(solver->num_vars, out_values, userdata))
+        return;
+    }
+
+    // Both branches of a decision whose negation was assigned below
+    // have been searched when that level is undone as well, thus the
+    // search ends when no decision is left.
+    if (solver->num_levels == 0)
+      return;
+    lit = solver->trail[solver->trail_lim[solver->num_levels - 1]];
+    solver_backtrack(solver, solver->num_levels - 1);
+    solver_assign(solver, lit_neg(lit), no_clause);
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_search(
+  struct solver* solver, bool* out_values,
+  clause_set_solve_callback callback, void* userdata, bool* sat)
+{
+  while (true) {
+    uint32_t const conflict = solver_propagate(solver);
+    size_t count, level, lbd, var;
+
+    if (solver->oom)
+      return;
+
+    // Another solver of the portfolio has finished.
+    if (solver->worker && SHARED_LOAD(&solver->worker->portfolio->winner) !=
+        solver->worker->portfolio->num_workers)
+      return;
+
+    if (conflict != no_clause) {
+      solver->num_conflicts++;
+
+      // A conflict without decisions can not be resolved, there are
+      // no (more) solutions.
+      if (solver->num_levels == 0) {
+        solver->unsat = true;
+        return;
+      }
+
+      solver_update_target(solver);
+
+      count = solver_analyze(solver, conflict, &level);
+      lbd = solver_lbd(solver, solver->learnt, count);
+      solver_record_lbd(solver, lbd);
+      solver_decay(solver);
+      solver_backtrack(solver, level);
+      if (!solver_learn(solver, solver->learnt, count, lbd, false))
+        return;
+      if (solver->worker)
+        solver_export(solver, solver->learnt, count, lbd);
+      continue;
+    }
+
+    if (solver->num_conflicts >= solver->reduce_next) {
+      solver_reduce(solver);
+      solver->reduce_interval += solver->options->reduce_increment;
+      solver->reduce_next = solver->num_conflicts + solver->reduce_interval;
+    }
+
+    if (solver->options->rephase_interval > 0 && solver->num_conflicts >= solver->rephase_next) {
+      solver_rephase(solver);
+      solver->rephase_next = solver->num_conflicts + solver->options->rephase_interval;
+    }
+
+    if (solver_should_restart(solver)) {
+      solver_backtrack(solver, 0);
+      solver->num_restarts++;
+      solver->restart_conflicts = 0;
+      solver->lbd_window_count = 0;
+      solver->lbd_window_sum = 0;
+      continue;
+    }
+
+    // The clauses of the other solvers of a portfolio are added on
+    // level 0, where their assigned literals can be dropped for good.
+    // Without restarts, that is only after a unit was learned.
+    if (solver->worker && solver->num_levels == 0 && solver_import(solver)) {
+      if (solver->unsat || solver->oom)
+        return;
+      continue;
+    }
+
+    var = solver_pick(solver);
+    if (var == solver->num_vars) {
+      // All variables are assigned and no clause is empty.
+      solver_model(solver, out_values);
+      *sat = true;
+      if (!callback || !callback(solver->num_vars, out_values, userdata))
+        return;
+      if (solver->num_levels == 0)
+        return;
+
+      // Every other solution differs in at least one decision. The
+      // blocking clause is unit after undoing the last decision.
+      count = solver->num_levels;
+      for (level = 0; level < count; ++level) {
+        solver->learnt[count - 1 - level] = lit_neg(solver->trail[solver->trail_lim[level]]);
+      }
+      solver_backtrack(solver, count - 1);
+      if (!solver_learn(solver, solver->learnt, count, count, true))
+        return;
+      continue;
+    }
+
+    solver_decide(solver, solver_phase_lit(solver, var));
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_probe(struct solver* solver)
+{
+  size_t budget = solver->options->probe_budget;
+  unsigned char* marks = calloc(solver->num_vars * 2, sizeof(*marks));
+  uint32_t* implied = malloc(sizeof(*implied) * solver->num_vars);
+  uint32_t* resolvents = malloc(sizeof(*resolvents) * solver->num_vars * 3);
+  uint32_t* parents = malloc(sizeof(*parents) * solver->num_vars);
+  uint32_t* positions = malloc(sizeof(*positions) * solver->num_vars);
+  size_t var;
+
+  if (solver->num_vars > 0 && (!marks || !implied || !resolvents || !parents || !positions)) {
+    solver->oom = true;
+    goto cleanup;
+  }
+
+  for (var = 0; var < solver->num_vars && budget > 0; ++var) {
+    uint32_t const lit = (uint32_t) var * 2;
+    size_t count, index, num_resolvents;
+    bool failed;
+
+    // Only the variables with binary clauses are probed, the others
+    // rarely imply anything on their own.
+    if (solver->values[lit] != value_unset ||
+        (solver->simplifier && solver->simplifier->eliminated[var]) ||
+        (solver->binaries[lit].count == 0 && solver->binaries[lit_neg(lit)].count == 0))
+      continue;
+
+    // Probe the positive literal and remember what it implies.
+    failed = !solver_probe_lit(solver, lit, &budget, resolvents, &num_resolvents, parents, positions);
+    count = 0;
+    if (!failed) {
+      for (index = solver->trail_lim[0] + 1; index < solver->trail_count; ++index) {
+        marks[solver->trail[index]] = 1;
+        implied[count++] = solver->trail[index];
+      }
+    }
+    solver_backtrack(solver, 0);
+    if (!solver_probe_learn(solver, lit, resolvents, num_resolvents, failed))
+      break;
+
+    // Probe the negative literal, the literals that both imply are
+    // true.
+    if (!failed) {
+      failed = !solver_probe_lit(solver, lit_neg(lit), &budget, resolvents, &num_resolvents, parents, positions);
+      if (!failed) {
+        uint32_t* both = resolvents + num_resolvents * 2;
+        size_t num_implied = 0;
+        for (index = solver->trail_lim[0] + 1; index < solver->trail_count; ++index) {
+          if (marks[solver->trail[index]])
+            both[num_implied++] = solver->trail[index];
+        }
+        solver_backtrack(solver, 0);
+        for (index = 0; index < num_implied; ++index) {
+          solver_assign(solver, both[index], no_clause);
+          solver->num_implied_lits++;
+        }
+      }
+      else {
+        solver_backtrack(solver, 0);
+      }
+      for (index = 0; index < count; ++index) {
+        marks[implied[index]] = 0;
+      }
+      if (!solver_probe_learn(solver, lit_neg(lit), resolvents, num_resolvents, failed))
+        break;
+    }
+  }
+
+  // Undo the phases saved while probing, the target phases are still
+  // the initial ones.
+  solver_rephase(solver);
+
+cleanup:
+  free(marks);
+  free(implied);
+  free(resolvents);
+  free(parents);
+  free(positions);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_probe_lit(
+  struct solver* solver, uint32_t lit, size_t* budget,
+  uint32_t* resolvents, size_t* num_resolvents,
+  uint32_t* parents, uint32_t* positions)
+{
+  size_t const start = solver->trail_count;
+  size_t index, assigned;
+  bool conflict;
+
+  solver->trail_lim[solver->num_levels++] = solver->trail_count;
+  solver_assign(solver, lit, no_clause);
+  *num_resolvents = 0;
+  conflict = (solver_propagate(solver) != no_clause);
+  assigned = solver->trail_count - start;
+  *budget = (*budget > assigned ? *budget - assigned : 0);
+  if (conflict)
+    return false;
+
+  parents[lit_var(lit)] = no_lit;
+  positions[lit_var(lit)] = (uint32_t) start;
+  for (index = start + 1; index < solver->trail_count; ++index) {
+    uint32_t const implied = solver->trail[index];
+    size_t const var = lit_var(implied);
+    uint32_t const reason = solver->reasons[var];
+    struct clause_header* clause;
+    uint32_t const* lits;
+    uint32_t dominator = no_lit;
+    size_t other, num_false = 0;
+
+    positions[var] = (uint32_t) index;
+    if (reason == binary_clause) {
+      uint32_t const parent = lit_neg(solver->reason_lits[var]);
+      parents[var] = (solver->levels[lit_var(parent)] == 0 ? lit : parent);
+      continue;
+    }
+
+    // The literals false on level 0 are no part of the resolvent. The
+    // deeper of two ancestors moves up until they meet, which ends at
+    // the probe at the latest.
+    clause = solver_clause(solver, reason);
+    lits = clause_lits(clause);
+    for (other = 1; other < clause->size; ++other) {
+      uint32_t ancestor = lit_neg(lits[other]);
+      if (solver->levels[lit_var(ancestor)] == 0)
+        continue;
+      num_false++;
+      if (dominator == no_lit) {
+        dominator = ancestor;
+        continue;
+      }
+      while (dominator != ancestor) {
+        if (positions[lit_var(dominator)] > positions[lit_var(ancestor)])
+          dominator = parents[lit_var(dominator)];
+        else
+          ancestor = parents[lit_var(ancestor)];
+      }
+    }
+    parents[var] = (dominator == no_lit ? lit : dominator);
+
+    // With a single false literal on the probe's level, the clause acts
+    // as a binary clause already.
+    if (num_false >= 2) {
+      resolvents[*num_resolvents * 2] = lit_neg(dominator);
+      resolvents[*num_resolvents * 2 + 1] = implied;
+      (*num_resolvents)++;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_probe_learn(
+  struct solver* solver, uint32_t lit, uint32_t const* resolvents,
+  size_t num_resolvents, bool failed)
+{
+  size_t const limit = solver->num_vars * probe_hbr_limit;
+  size_t index;
+  if (failed) {
+    solver->num_failed_lits++;
+    solver_assign(solver, lit_neg(lit), no_clause);
+  }
+  else {
+    for (index = 0; index < num_resolvents && solver->num_hyper_binaries < limit; ++index) {
+      uint32_t const a = resolvents[index * 2];
+      uint32_t const b = resolvents[index * 2 + 1];
+      if (solver_has_binary(solver, a, b))
+        continue;
+      if (!solver_add_binary(solver, a, b))
+        return false;
+      solver->num_hyper_binaries++;
+    }
+  }
+  if (solver_propagate(solver) != no_clause) {
+    solver->unsat = true;
+    return false;
+  }
+  return !solver->oom;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_model(struct solver* solver, bool* out_values)
+{
+  size_t var;
+  for (var = 0; var < solver->num_vars; ++var) {
+    out_values[var] = (solver->values[var * 2] == value_true);
+  }
+  if (solver->simplifier)
+    simplifier_extend(solver->simplifier, out_values);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_store_stats(
+  struct solver const* solver, struct clause_set_solve_stats* stats)
+{
+  stats->conflicts = solver->num_conflicts;
+  stats->decisions = solver->num_decisions;
+  stats->restarts = solver->num_restarts;
+  stats->learned_lits = solver->num_learned_lits;
+  stats->minimized_lits = solver->num_minimized_lits;
+  stats->failed_lits = solver->num_failed_lits;
+  stats->implied_lits = solver->num_implied_lits;
+  stats->hyper_binaries = solver->num_hyper_binaries;
+  stats->imported = solver->num_imported;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_diversify(struct solver* solver, size_t seed)
+{
+  uint64_t state = (uint64_t) seed * 0x9e3779b97f4a7c15ull + 1;
+  size_t var, pos;
+  for (var = 0; var < solver->num_vars; ++var) {
+    // xorshift64, the top 53 bits give an activity below 1e-3, which
+    // the first bump outweighs.
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    solver->activity[var] = (double) (state >> 11) / 9007199254740992.0 * 1e-3;
+    solver->phases[var] = !(seed & 1);
+    solver->target_phases[var] = !(seed & 1);
+  }
+  for (pos = solver->heap_count / 2; pos-- > 0;) {
+    solver_heap_down(solver, pos);
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_export(
+  struct solver* solver, uint32_t const* lits, size_t count, size_t lbd)
+{
+  struct share_ring* ring = &solver->worker->ring;
+  size_t const mask = share_ring_words - 1;
+  size_t const head = ring->head;
+  size_t index;
+
+  if (count > 2 && (count > share_size_limit || lbd > share_lbd_limit))
+    return;
+
+  // The readers check #reserved after they copied a clause, thus it is
+  // raised before the words it covers are overwritten.
+  SHARED_STORE(&ring->reserved, head + count + 2);
+  SHARED_FENCE_RELEASE();
+  SHARED_STORE(&ring->words[head & mask], (uint32_t) count);
+  SHARED_STORE(&ring->words[(head + 1) & mask], (uint32_t) lbd);
+  for (index = 0; index < count; ++index) {
+    SHARED_STORE(&ring->words[(head + 2 + index) & mask], lits[index]);
+  }
+  SHARED_STORE_RELEASE(&ring->head, head + count + 2);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_import(struct solver* solver)
+{
+  struct portfolio_worker* worker = solver->worker;
+  struct portfolio const* portfolio = worker->portfolio;
+  size_t const mask = share_ring_words - 1;
+  bool added = false;
+  size_t other;
+
+  assert(solver->num_levels == 0);
+  for (other = 0; other < portfolio->num_workers; ++other) {
+    struct share_ring* ring = &portfolio->workers[other].ring;
+    size_t const head = SHARED_LOAD_ACQUIRE(&ring->head);
+    size_t pos = worker->positions[other];
+
+    if (other == worker->index)
+      continue;
+    while (pos != head) {
+      size_t const size = SHARED_LOAD(&ring->words[pos & mask]);
+      size_t lbd = SHARED_LOAD(&ring->words[(pos + 1) & mask]);
+      size_t index, count = 0;
+      bool satisfied = false;
+      uint32_t ref;
+
+      // A size that was torn by the owner is discarded below.
+      for (index = 0; index < size && index < share_size_limit; ++index) {
+        worker->import[index] = SHARED_LOAD(&ring->words[(pos + 2 + index) & mask]);
+      }
+      SHARED_FENCE_ACQUIRE();
+      if (SHARED_LOAD(&ring->reserved) - pos > share_ring_words) {
+        // The owner overwrote the clause, the reader was too slow.
+        pos = head;
+        break;
+      }
+      assert(size <= share_size_limit);
+      pos += size + 2;
+
+      for (index = 0; index < size && !satisfied; ++index) {
+        uint32_t const lit = worker->import[index];
+        enum value const value = solver_lit_value(solver, lit);
+        if (value == value_true)
+          satisfied = true;
+        else if (value == value_unset)
+          worker->import[count++] = lit;
+      }
+      if (satisfied)
+        continue;
+
+      added = true;
+      solver->num_imported++;
+      if (count == 0) {
+        solver->unsat = true;
+        break;
+      }
+      else if (count == 1) {
+        solver_assign(solver, worker->import[0], no_clause);
+      }
+      else if (count == 2) {
+        if (!solver_add_binary(solver, worker->import[0], worker->import[1]))
+          break;
+      }
+      else {
+        if (lbd > count)
+          lbd = count;
+        ref = solver_alloc_clause(solver, count,
+          clause_flag_learnt | (uint32_t) lbd << clause_lbd_shift);
+        if (ref == no_clause)
+          break;
+        memcpy(clause_lits(solver_clause(solver, ref)), worker->import, sizeof(uint32_t) * count);
+        solver->num_learnts++;
+        if (!solver_watch(solver, worker->import[0], ref, worker->import[1]) ||
+            !solver_watch(solver, worker->import[1], ref, worker->import[0]))
+          break;
+      }
+    }
+    worker->positions[other] = pos;
+    if (solver->unsat || solver->oom)
+      break;
+  }
+  return added;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool portfolio_solve(
+  struct clause_set* clauses, struct clause_set_solve_options const* options,
+  struct simplifier const* simplifier, size_t num_workers,
+  bool* out_values, bool* sat)
+{
+  struct portfolio portfolio;
+  size_t index;
+  bool ok = true;
+
+  portfolio.clauses = clauses;
+  portfolio.simplifier = simplifier;
+  portfolio.num_workers = num_workers;
+  portfolio.probed = NULL;
+  portfolio.num_probed_units = 0;
+  portfolio.num_probed_binaries = 0;
+  portfolio.winner = num_workers;
+  portfolio.workers = calloc(num_workers, sizeof(*portfolio.workers));
+  if (portfolio.workers == NULL)
+    return false;
+
+  // The first solver runs with the options as they are, the others
+  // alternate the restart policies and rephase less often.
+  for (index = 0; index < num_workers; ++index) {
+    struct portfolio_worker* worker = &portfolio.workers[index];
+    worker->portfolio = &portfolio;
+    worker->index = index;
+    worker->options = *options;
+    worker->options.stats = NULL;
+    if (index > 0) {
+      worker->options.restarts = (index % 2 ? restarts_luby : restarts_glucose);
+      worker->options.rephase_interval *= 1 + index % 3;
+    }
+    worker->values = malloc(sizeof(bool) * clauses->num_vars);
+    worker->ring.words = calloc(share_ring_words, sizeof(uint32_t));
+    worker->positions = calloc(num_workers, sizeof(size_t));
+    worker->import = malloc(sizeof(uint32_t) * share_size_limit);
+    if ((clauses->num_vars > 0 && !worker->values) || !worker->ring.words ||
+        !worker->positions || !worker->import)
+      ok = false;
+  }
+
+  // The first solver probes before the others start, and it runs on
+  // the calling thread. If probing decided the clauses, the others are
+  // not needed.
+  if (ok && portfolio_prepare(&portfolio.workers[0]) &&
+      portfolio.workers[0].solver.unsat)
+    num_workers = 1;
+#ifndef _MSC_VER
+  if (ok) {
+    pthread_t* threads = malloc(sizeof(*threads) * num_workers);
+    bool* started = calloc(num_workers, sizeof(*started));
+    if (threads && started) {
+      for (index = 1; index < num_workers; ++index)
+        started[index] = pthread_create(&threads[index], NULL, portfolio_thread, &portfolio.workers[index]) == 0;
+    }
+    portfolio_thread(&portfolio.workers[0]);
+    for (index = 1; index < num_workers; ++index) {
+      if (started && started[index])
+        pthread_join(threads[index], NULL);
+    }
+    free(threads);
+    free(started);
+  }
+#else
+  if (ok)
+    portfolio_thread(&portfolio.workers[0]);
+#endif
+
+  if (portfolio.winner < portfolio.num_workers) {
+    struct portfolio_worker const* winner = &portfolio.workers[portfolio.winner];
+    *sat = winner->sat;
+    if (winner->sat)
+      memcpy(out_values, winner->values, sizeof(bool) * clauses->num_vars);
+    if (options->stats)
+      solver_store_stats(&winner->solver, options->stats);
+  }
+  else {
+    ok = false;
+  }
+
+  for (index = 0; index < portfolio.num_workers; ++index) {
+    struct portfolio_worker* worker = &portfolio.workers[index];
+    solver_free(&worker->solver);
+    free(worker->values);
+    free(worker->ring.words);
+    free(worker->positions);
+    free(worker->import);
+  }
+  free(portfolio.workers);
+  free(portfolio.probed);
+  return ok;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool portfolio_prepare(struct portfolio_worker* worker)
+{
+  struct portfolio* portfolio = worker->portfolio;
+  struct solver* solver = &worker->solver;
+  size_t* binary_counts = NULL;
+  size_t index, lit;
+
+  worker->prepared = true;
+  if (!solver_init(solver, portfolio->clauses, &worker->options, portfolio->simplifier)) {
+    solver->oom = true;
+    return false;
+  }
+  solver->worker = worker;
+  if (worker->index > 0) {
+    solver_diversify(solver, worker->index);
+    for (index = 0; index < portfolio->num_probed_units && !solver->unsat; ++index) {
+      if (!solver_assign(solver, portfolio->probed[index], no_clause))
+        solver->unsat = true;
+    }
+    for (index = 0; index < portfolio->num_probed_binaries; ++index) {
+      uint32_t const* pair = portfolio->probed + portfolio->num_probed_units + index * 2;
+      if (!solver_add_binary(solver, pair[0], pair[1]))
+        return false;
+    }
+  }
+  if (solver->unsat || solver_propagate(solver) != no_clause) {
+    solver->unsat = true;
+    return !solver->oom;
+  }
+  if (worker->index > 0 || worker->options.probe_budget == 0)
+    return !solver->oom;
+
+  // Probing appends the resolvents to the implication lists, the
+  // entries beyond the counts before probing are new. Each resolvent is
+  // in the lists of both of its literals and is recorded once.
+  binary_counts = malloc(sizeof(*binary_counts) * solver->num_vars * 2);
+  if (solver->num_vars > 0 && !binary_counts) {
+    solver->oom = true;
+    return false;
+  }
+  for (lit = 0; lit < solver->num_vars * 2; ++lit) {
+    binary_counts[lit] = solver->binaries[lit].count;
+  }
+  solver_probe(solver);
+  if (!solver->unsat && !solver->oom) {
+    size_t num_binaries = 0;
+    for (lit = 0; lit < solver->num_vars * 2; ++lit) {
+      num_binaries += solver->binaries[lit].count - binary_counts[lit];
+    }
+    portfolio->probed = malloc(sizeof(uint32_t) * (solver->trail_count + num_binaries + 1));
+    if (portfolio->probed) {
+      memcpy(portfolio->probed, solver->trail, sizeof(uint32_t) * solver->trail_count);
+      portfolio->num_probed_units = solver->trail_count;
+      for (lit = 0; lit < solver->num_vars * 2; ++lit) {
+        struct implication_list const* list = &solver->binaries[lit];
+        for (index = binary_counts[lit]; index < list->count; ++index) {
+          if (lit < list->lits[index]) {
+            uint32_t* pair = portfolio->probed + portfolio->num_probed_units +
+              portfolio->num_probed_binaries * 2;
+            pair[0] = (uint32_t) lit;
+            pair[1] = list->lits[index];
+            portfolio->num_probed_binaries++;
+          }
+        }
+      }
+    }
+  }
+  free(binary_counts);
+  return !solver->oom;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void* portfolio_thread(void* arg)
+{
+  struct portfolio_worker* worker = arg;
+  struct portfolio* portfolio = worker->portfolio;
+  struct solver* solver = &worker->solver;
+  size_t expected = portfolio->num_workers;
+
+  if (!worker->prepared && !portfolio_prepare(worker))
+    return NULL;
+  if (!solver->unsat && !solver->oom)
+    solver_search(solver, worker->values, NULL, NULL, &worker->sat);
+
+  // A solver that was stopped or ran out of memory has no result.
+  if (!solver->oom && (worker->sat || solver->unsat))
+    SHARED_CLAIM(&portfolio->winner, expected, worker->index);
+  return NULL;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_lbd(struct solver* solver, uint32_t const* lits, size_t count)
+{
+  size_t index, lbd = 0;
+  solver->stamp++;
+  for (index = 0; index < count; ++index) {
+    size_t const level = solver->levels[lit_var(lits[index])];
+    if (solver->level_stamps[level] != solver->stamp) {
+      solver->level_stamps[level] = solver->stamp;
+      lbd++;
+    }
+  }
+  return lbd;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_clause_lbd(struct solver* solver, struct clause_header* clause)
+{
+  uint32_t const* lits = clause_lits(clause);
+  size_t index, lbd = 0;
+  solver->stamp++;
+  for (index = 0; index < clause->size; ++index) {
+    size_t const level = solver->levels[lit_var(lits[index])];
+    if (solver->level_stamps[level] != solver->stamp) {
+      solver->level_stamps[level] = solver->stamp;
+      lbd++;
+    }
+  }
+  return lbd;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_record_lbd(struct solver* solver, size_t lbd)
+{
+  size_t const window = solver->options->glucose_window;
+  solver->restart_conflicts++;
+  solver->lbd_sum += (double) lbd;
+  if (window == 0)
+    return;
+  if (solver->lbd_window_count == window)
+    solver->lbd_window_sum -= solver->lbd_window[solver->lbd_window_pos];
+  else
+    solver->lbd_window_count++;
+  solver->lbd_window[solver->lbd_window_pos] = lbd;
+  solver->lbd_window_sum += lbd;
+  solver->lbd_window_pos = (solver->lbd_window_pos + 1) % window;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_should_restart(struct solver* solver)
+{
+  struct clause_set_solve_options const* options = solver->options;
+  switch (options->restarts) {
+    case restarts_luby:
+      return solver->restart_conflicts >= options->luby_unit * luby(solver->num_restarts);
+    case restarts_glucose:
+      // Restart when the recently learned clauses are of worse quality
+      // than the average learned clause.
+      if (options->glucose_window == 0 || solver->lbd_window_count < options->glucose_window)
+        return false;
+      return (double) solver->lbd_window_sum / (double) options->glucose_window *
+        options->glucose_factor > solver->lbd_sum / (double) solver->num_conflicts;
+    case restarts_none:
+    default:
+      return false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t luby(size_t index)
+{
+  // Find the finite subsequence that contains the index and the
+  // exponent of its last element.
+  size_t size = 1, seq = 0;
+  while (size < index + 1) {
+    seq++;
+    size = size * 2 + 1;
+  }
+  while (size - 1 != index) {
+    size = (size - 1) / 2;
+    seq--;
+    index = index % size;
+  }
+  return (size_t) 1 << seq;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_analyze(
+  struct solver* solver, uint32_t conflict, size_t* out_level)
+{
+  size_t count = 1;  // The first literal is the asserting literal.
+  size_t paths = 0;
+  size_t index = solver->trail_count;
+  size_t max, learned;
+  uint32_t lit = no_lit;
+
+  // Resolve the conflict clause with the reasons of the literals of the
+  // current decision level, in reverse trail order, until only one
+  // literal of the current level is left.
+  do {
+    uint32_t pair[2];
+    size_t size, j;
+    uint32_t const* lits = solver_reason_lits(solver, conflict, lit, pair, &size);
+    if (conflict != binary_clause)
+      solver_bump_clause(solver, conflict);
+    for (j = (lit == no_lit ? 0 : 1); j < size; ++j) {
+      uint32_t const other = lits[j];
+      size_t const var = lit_var(other);
+      if (!solver->seen[var] && solver->levels[var] > 0) {
+        solver->seen[var] = true;
+        solver_bump(solver, var);
+        if (solver->levels[var] >= solver->num_levels)
+          paths++;
+        else
+          solver->learnt[count++] = other;
+      }
+    }
+
+    do {
+      lit = solver->trail[--index];
+    } while (!solver->seen[lit_var(lit)]);
+    conflict = solver->reasons[lit_var(lit)];
+    solver->seen[lit_var(lit)] = false;
+    paths--;
+  } while (paths > 0);
+  solver->learnt[0] = lit_neg(lit);
+
+  // The variables of the other literals are still marked, they are
+  // cleared together with the ones marked by the minimization.
+  learned = count;
+  memcpy(solver->analyze_toclear, solver->learnt + 1, sizeof(*solver->learnt) * (count - 1));
+  solver->toclear_count = count - 1;
+  if (solver->options->minimize)
+    count = solver_minimize(solver, count);
+  for (index = 0; index < solver->toclear_count; ++index) {
+    solver->seen[lit_var(solver->analyze_toclear[index])] = false;
+  }
+  if (solver->options->minimize_binary && count <= minimize_binary_limit)
+    count = solver_minimize_binary(solver, count);
+  solver->num_learned_lits += learned;
+  solver->num_minimized_lits += learned - count;
+
+  // Find the literal with the highest level among the others and move
+  // it to the second position, it is watched together with the first.
+  *out_level = 0;
+  max = 1;
+  for (index = 1; index < count; ++index) {
+    size_t const level = solver->levels[lit_var(solver->learnt[index])];
+    if (level > *out_level) {
+      *out_level = level;
+      max = index;
+    }
+  }
+  if (count > 1) {
+    lit = solver->learnt[1];
+    solver->learnt[1] = solver->learnt[max];
+    solver->learnt[max] = lit;
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t solver_abstract_level(struct solver* solver, size_t var)
+{
+  return (uint32_t) 1 << (solver->levels[var] & 31);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_minimize(struct solver* solver, size_t count)
+{
+  uint32_t abstract = 0;
+  size_t i, j;
+  for (i = 1; i < count; ++i) {
+    abstract |= solver_abstract_level(solver, lit_var(solver->learnt[i]));
+  }
+  for (i = 1, j = 1; i < count; ++i) {
+    uint32_t const lit = solver->learnt[i];
+    if (solver->reasons[lit_var(lit)] == no_clause || !solver_redundant(solver, lit, abstract))
+      solver->learnt[j++] = lit;
+  }
+  return j;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_redundant(struct solver* solver, uint32_t lit, uint32_t abstract)
+{
+  size_t const top = solver->toclear_count;
+  size_t depth = 0;
+
+  solver->analyze_stack[depth++] = lit;
+  while (depth > 0) {
+    uint32_t const false_lit = solver->analyze_stack[--depth];
+    uint32_t pair[2];
+    size_t size, j;
+    uint32_t const* lits = solver_reason_lits(
+      solver, solver->reasons[lit_var(false_lit)], lit_neg(false_lit), pair, &size);
+
+    for (j = 1; j < size; ++j) {
+      uint32_t const other = lits[j];
+      size_t const var = lit_var(other);
+      if (solver->seen[var] || solver->levels[var] == 0)
+        continue;
+      if (solver->reasons[var] == no_clause || !(solver_abstract_level(solver, var) & abstract)) {
+        // Undo the marks of this search, the literal must be kept.
+        for (j = top; j < solver->toclear_count; ++j) {
+          solver->seen[lit_var(solver->analyze_toclear[j])] = false;
+        }
+        solver->toclear_count = top;
+        return false;
+      }
+      solver->seen[var] = true;
+      solver->analyze_stack[depth++] = other;
+      solver->analyze_toclear[solver->toclear_count++] = other;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_minimize_binary(struct solver* solver, size_t count)
+{
+  struct implication_list const* implied = &solver->binaries[solver->learnt[0]];
+  size_t i, j;
+
+  // A binary clause of the asserting literal and the negation of another
+  // literal resolves that literal away. Its mark is cleared to drop it.
+  for (i = 1; i < count; ++i) {
+    solver->seen[lit_var(solver->learnt[i])] = true;
+  }
+  for (i = 0; i < implied->count; ++i) {
+    uint32_t const other = implied->lits[i];
+    if (solver->seen[lit_var(other)] && solver_lit_value(solver, other) == value_true)
+      solver->seen[lit_var(other)] = false;
+  }
+  for (i = 1, j = 1; i < count; ++i) {
+    uint32_t const lit = solver->learnt[i];
+    if (solver->seen[lit_var(lit)]) {
+      solver->seen[lit_var(lit)] = false;
+      solver->learnt[j++] = lit;
+    }
+  }
+  return j;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_learn(
+  struct solver* solver, uint32_t* lits, size_t count, size_t lbd,
+  bool permanent)
+{
+  uint32_t ref;
+
+  // Unit clauses are assigned on level 0 without a reason.
+  if (count == 1) {
+    assert(solver->num_levels == 0);
+    solver_assign(solver, lits[0], no_clause);
+    return true;
+  }
+
+  // Binary clauses are learned into the implication lists, they are
+  // never deleted.
+  if (count == 2) {
+    if (!solver_add_binary(solver, lits[0], lits[1]))
+      return false;
+    solver_assign_binary(solver, lits[0], lits[1]);
+    return true;
+  }
+
+  ref = solver_alloc_clause(solver, count,
+    clause_flag_learnt | (permanent ? clause_flag_permanent : 0) |
+    (uint32_t) lbd << clause_lbd_shift);
+  if (ref == no_clause)
+    return false;
+  memcpy(clause_lits(solver_clause(solver, ref)), lits, sizeof(*lits) * count);
+  solver->num_learnts++;
+  if (!solver_watch(solver, lits[0], ref, lits[1]) || !solver_watch(solver, lits[1], ref, lits[0]))
+    return false;
+  solver_assign(solver, lits[0], ref);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_bump_clause(struct solver* solver, uint32_t ref)
+{
+  struct clause_header* clause = solver_clause(solver, ref);
+  size_t lbd;
+
+  if (!(clause->flags & clause_flag_learnt))
+    return;
+  clause->flags |= clause_flag_used;
+  clause->activity += (float) solver->clause_inc;
+  if (clause->activity > clause_activity_limit) {
+    size_t offset = solver->learnts_begin;
+    while (offset < solver->arena_count) {
+      struct clause_header* other = solver_clause(solver, (uint32_t) offset);
+      other->activity /= (float) clause_activity_limit;
+      offset += CLAUSE_HEADER_WORDS + other->size;
+    }
+    solver->clause_inc /= clause_activity_limit;
+  }
+
+  if (clause_lbd(clause) > glue_lbd) {
+    lbd = solver_clause_lbd(solver, clause);
+    if (lbd < clause_lbd(clause)) {
+      clause->flags &= (1u << clause_lbd_shift) - 1;
+      clause->flags |= (uint32_t) lbd << clause_lbd_shift;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_locked(struct solver* solver, uint32_t ref)
+{
+  uint32_t const lit = clause_lits(solver_clause(solver, ref))[0];
+  return solver_lit_value(solver, lit) == value_true &&
+    solver->reasons[lit_var(lit)] == ref;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_reduce(struct solver* solver)
+{
+  struct reduce_candidate* candidates = NULL;
+  uint32_t* from = NULL;
+  uint32_t* to = NULL;
+  size_t num_candidates = 0, num_moved = 0;
+  size_t index, offset, dest;
+
+  if (solver->num_learnts == 0)
+    return;
+  candidates = malloc(sizeof(*candidates) * solver->num_learnts);
+  from = malloc(sizeof(*from) * solver->num_learnts);
+  to = malloc(sizeof(*to) * solver->num_learnts);
+  if (candidates == NULL || from == NULL || to == NULL) {
+    // Not reducing the learned clauses is no error.
+    free(candidates);
+    free(from);
+    free(to);
+    return;
+  }
+
+  offset = solver->learnts_begin;
+  while (offset < solver->arena_count) {
+    uint32_t const ref = (uint32_t) offset;
+    struct clause_header* clause = solver_clause(solver, ref);
+    bool const used = (clause->flags & clause_flag_used) != 0;
+    offset += CLAUSE_HEADER_WORDS + clause->size;
+    clause->flags &= ~(uint32_t) clause_flag_used;
+    if ((clause->flags & clause_flag_permanent) || clause_lbd(clause) <= glue_lbd)
+      continue;
+    if (clause_lbd(clause) <= solver->options->tier2_lbd && used)
+      continue;
+    if (solver_locked(solver, ref))
+      continue;
+    candidates[num_candidates].activity = clause->activity;
+    candidates[num_candidates].ref = ref;
+    num_candidates++;
+  }
+
+  qsort(candidates, num_candidates, sizeof(*candidates), compare_reduce_candidates);
+  for (index = 0; index < num_candidates / 2; ++index) {
+    solver_clause(solver, candidates[index].ref)->flags |= clause_flag_deleted;
+  }
+
+  // Move the remaining learned clauses together. They keep their order,
+  // thus the old and new references are sorted.
+  offset = solver->learnts_begin;
+  dest = solver->learnts_begin;
+  while (offset < solver->arena_count) {
+    struct clause_header* clause = solver_clause(solver, (uint32_t) offset);
+    size_t const words = CLAUSE_HEADER_WORDS + clause->size;
+    if (clause->flags & clause_flag_deleted) {
+      solver->num_learnts--;
+      solver->num_deleted++;
+    }
+    else {
+      from[num_moved] = (uint32_t) offset;
+      to[num_moved] = (uint32_t) dest;
+      num_moved++;
+      memmove(solver->arena + dest, clause, sizeof(*solver->arena) * words);
+      dest += words;
+    }
+    offset += words;
+  }
+  solver->arena_count = dest;
+
+  // Update the references in the reasons and the watch lists.
+  for (index = 0; index < solver->trail_count; ++index) {
+    size_t const var = lit_var(solver->trail[index]);
+    uint32_t const reason = solver->reasons[var];
+    if (reason != no_clause && reason != binary_clause && reason >= solver->learnts_begin)
+      solver->reasons[var] = relocate(reason, from, to, num_moved);
+  }
+  for (index = 0; index < solver->num_vars * 2; ++index) {
+    struct watch_list* list = &solver->watches[index];
+    size_t i, j;
+    for (i = 0, j = 0; i < list->count; ++i) {
+      struct watcher watcher = list->watchers[i];
+      if (watcher.ref >= solver->learnts_begin) {
+        watcher.ref = relocate(watcher.ref, from, to, num_moved);
+        if (watcher.ref == no_clause)
+          continue;
+      }
+      list->watchers[j++] = watcher;
+    }
+    list->count = j;
+  }
+
+  free(candidates);
+  free(from);
+  free(to);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t relocate(
+  uint32_t ref, uint32_t const* from, uint32_t const* to, size_t count)
+{
+  size_t low = 0, high = count;
+  while (low < high) {
+    size_t const mid = low + (high - low) / 2;
+    if (from[mid] < ref)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  if (low < count && from[low] == ref)
+    return to[low];
+  return no_clause;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static int compare_reduce_candidates(const void* a, const void* b)
+{
+  float const lhs = ((struct reduce_candidate const*) a)->activity;
+  float const rhs = ((struct reduce_candidate const*) b)->activity;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t lit_var(uint32_t lit)
+{
+  return lit >> 1;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t lit_neg(uint32_t lit)
+{
+  return lit ^ 1;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool lit_positive(uint32_t lit)
+{
+  return (lit & 1) == 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static enum value solver_lit_value(struct solver* solver, uint32_t lit)
+{
+  return (enum value) solver->values[lit];
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_init(
+  struct solver* solver, struct clause_set* set,
+  struct clause_set_solve_options const* options,
+  struct simplifier const* simplifier)
+{
+  size_t index;
+
+  solver->num_vars = set->num_vars;
+  solver->values = malloc(sizeof(*solver->values) * set->num_vars * 2);
+  solver->watches = calloc(set->num_vars * 2, sizeof(*solver->watches));
+  solver->binaries = calloc(set->num_vars * 2, sizeof(*solver->binaries));
+  solver->trail = malloc(sizeof(*solver->trail) * set->num_vars);
+  solver->trail_count = 0;
+  solver->trail_head = 0;
+  solver->binary_head = 0;
+  solver->trail_lim = malloc(sizeof(*solver->trail_lim) * set->num_vars);
+  solver->num_levels = 0;
+  solver->levels = malloc(sizeof(*solver->levels) * set->num_vars);
+  solver->reasons = malloc(sizeof(*solver->reasons) * set->num_vars);
+  solver->reason_lits = malloc(sizeof(*solver->reason_lits) * set->num_vars);
+  solver->seen = calloc(set->num_vars, sizeof(*solver->seen));
+  solver->learnt = malloc(sizeof(*solver->learnt) * set->num_vars);
+  solver->analyze_stack = malloc(sizeof(*solver->analyze_stack) * set->num_vars);
+  solver->analyze_toclear = malloc(sizeof(*solver->analyze_toclear) * set->num_vars);
+  solver->toclear_count = 0;
+  solver->activity = malloc(sizeof(*solver->activity) * set->num_vars);
+  solver->var_inc = 1.0;
+  solver->heap = malloc(sizeof(*solver->heap) * set->num_vars);
+  solver->heap_count = 0;
+  solver->heap_index = malloc(sizeof(*solver->heap_index) * set->num_vars);
+  solver->phases = malloc(sizeof(*solver->phases) * set->num_vars);
+  solver->target_phases = malloc(sizeof(*solver->target_phases) * set->num_vars);
+  solver->target_size = 0;
+  solver->rephase_next = options->rephase_interval;
+  solver->num_conflicts = 0;
+  solver->num_decisions = 0;
+  solver->num_learned_lits = 0;
+  solver->num_minimized_lits = 0;
+  solver->num_failed_lits = 0;
+  solver->num_implied_lits = 0;
+  solver->num_hyper_binaries = 0;
+  solver->num_imported = 0;
+  solver->options = options;
+  solver->simplifier = simplifier;
+  solver->worker = NULL;
+  solver->num_restarts = 0;
+  solver->restart_conflicts = 0;
+  solver->lbd_window = malloc(sizeof(*solver->lbd_window) * (options->glucose_window + 1));
+  solver->lbd_window_count = 0;
+  solver->lbd_window_pos = 0;
+  solver->lbd_window_sum = 0;
+  solver->lbd_sum = 0.0;
+  solver->level_stamps = calloc(set->num_vars + 1, sizeof(*solver->level_stamps));
+  solver->stamp = 0;
+  solver->arena = NULL;
+  solver->arena_count = 0;
+  solver->arena_capacity = 0;
+  solver->learnts_begin = 0;
+  solver->num_learnts = 0;
+  solver->clause_inc = 1.0;
+  solver->reduce_interval = options->reduce_interval;
+  solver->reduce_next = options->reduce_interval;
+  solver->num_deleted = 0;
+  solver->unsat = false;
+  solver->oom = false;
+  if (!solver->lbd_window || !solver->level_stamps) {
+    return false;
+  }
+  if (set->num_vars > 0 && (!solver->values || !solver->watches ||
+      !solver->binaries || !solver->trail || !solver->trail_lim ||
+      !solver->levels || !solver->reasons || !solver->reason_lits ||
+      !solver->seen || !solver->learnt || !solver->analyze_stack ||
+      !solver->analyze_toclear ||
+      !solver->activity || !solver->heap || !solver->heap_index ||
+      !solver->phases || !solver->target_phases)) {
+    return false;
+  }
+
+  memset(solver->values, value_unset, sizeof(*solver->values) * set->num_vars * 2);
+  for (index = 0; index < set->num_vars; ++index) {
+    solver->activity[index] = 0.0;
+    solver->phases[index] = true;
+    solver->target_phases[index] = true;
+    solver->heap_index[index] = not_in_heap;
+    if (!simplifier || !simplifier->eliminated[index])
+      solver_heap_insert(solver, index);
+  }
+
+  for (index = 0; index < set->count; ++index) {
+    uint32_t const* lits = set->lits + set->offsets[index];
+    size_t const count = set->offsets[index + 1] - set->offsets[index];
+    if (count == 0) {
+      // The empty clause can not be satisfied.
+      solver->unsat = true;
+    }
+    else if (count == 1) {
+      // Unit clauses have nothing to watch, they are assigned before
+      // the first decision.
+      if (!solver_assign(solver, lits[0], no_clause))
+        solver->unsat = true;
+    }
+    else if (count == 2) {
+      if (!solver_add_binary(solver, lits[0], lits[1]))
+        return false;
+    }
+    else {
+      uint32_t const ref = solver_alloc_clause(solver, count, 0);
+      if (ref == no_clause)
+        return false;
+      memcpy(clause_lits(solver_clause(solver, ref)), lits, sizeof(*lits) * count);
+      if (!solver_watch(solver, lits[0], ref, lits[1]) ||
+          !solver_watch(solver, lits[1], ref, lits[0]))
+        return false;
+    }
+  }
+  solver->learnts_begin = solver->arena_count;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_free(struct solver* solver)
+{
+  size_t index;
+  if (solver->watches) {
+    for (index = 0; index < solver->num_vars * 2; ++index) {
+      free(solver->watches[index].watchers);
+    }
+  }
+  if (solver->binaries) {
+    for (index = 0; index < solver->num_vars * 2; ++index) {
+      free(solver->binaries[index].lits);
+    }
+  }
+  free(solver->values);
+  free(solver->watches);
+  free(solver->binaries);
+  free(solver->trail);
+  free(solver->trail_lim);
+  free(solver->levels);
+  free(solver->reasons);
+  free(solver->reason_lits);
+  free(solver->seen);
+  free(solver->learnt);
+  free(solver->analyze_stack);
+  free(solver->analyze_toclear);
+  free(solver->activity);
+  free(solver->heap);
+  free(solver->heap_index);
+  free(solver->phases);
+  free(solver->target_phases);
+  free(solver->lbd_window);
+  free(solver->level_stamps);
+  free(solver->arena);
+  solver->values = NULL;
+  solver->watches = NULL;
+  solver->binaries = NULL;
+  solver->trail = NULL;
+  solver->trail_lim = NULL;
+  solver->levels = NULL;
+  solver->reasons = NULL;
+  solver->reason_lits = NULL;
+  solver->seen = NULL;
+  solver->learnt = NULL;
+  solver->analyze_stack = NULL;
+  solver->analyze_toclear = NULL;
+  solver->activity = NULL;
+  solver->heap = NULL;
+  solver->heap_index = NULL;
+  solver->phases = NULL;
+  solver->target_phases = NULL;
+  solver->lbd_window = NULL;
+  solver->level_stamps = NULL;
+  solver->arena = NULL;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static struct clause_header* solver_clause(struct solver* solver, uint32_t ref)
+{
+  return (struct clause_header*) (solver->arena + ref);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t* clause_lits(struct clause_header* clause)
+{
+  return (uint32_t*) (clause + 1);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t clause_lbd(struct clause_header* clause)
+{
+  return clause->flags >> clause_lbd_shift;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t solver_alloc_clause(
+  struct solver* solver, size_t count, uint32_t flags)
+{
+  size_t const words = CLAUSE_HEADER_WORDS + count;
+  struct clause_header* clause;
+
+  // The references are 32-bit offsets below #binary_clause.
+  if (solver->arena_count + words >= binary_clause) {
+    solver->oom = true;
+    return no_clause;
+  }
+  if (solver->arena_count + words > solver->arena_capacity) {
+    size_t new_capacity = (solver->arena_capacity == 0 ? 1024 : solver->arena_capacity * 2);
+    uint32_t* new_arena;
+    while (new_capacity < solver->arena_count + words)
+      new_capacity *= 2;
+    new_arena = realloc(solver->arena, sizeof(*new_arena) * new_capacity);
+    if (new_arena == NULL) {
+      solver->oom = true;
+      return no_clause;
+    }
+    solver->arena_capacity = new_capacity;
+    solver->arena = new_arena;
+  }
+
+  clause = solver_clause(solver, (uint32_t) solver->arena_count);
+  clause->size = (uint32_t) count;
+  clause->flags = flags;
+  clause->activity = 0.0f;
+  solver->arena_count += words;
+  return (uint32_t) (solver->arena_count - words);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_watch(
+  struct solver* solver, uint32_t lit, uint32_t ref, uint32_t blocker)
+{
+  struct watch_list* list = &solver->watches[lit];
+  if (list->count + 1 > list->capacity) {
+    size_t new_capacity = (list->capacity == 0 ? 4 : list->capacity * 2);
+    struct watcher* new_watchers = realloc(list->watchers, sizeof(*new_watchers) * new_capacity);
+    if (new_watchers == NULL) {
+      solver->oom = true;
+      return false;
+    }
+    list->capacity = new_capacity;
+    list->watchers = new_watchers;
+  }
+  list->watchers[list->count].ref = ref;
+  list->watchers[list->count].blocker = blocker;
+  list->count++;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_add_binary(struct solver* solver, uint32_t a, uint32_t b)
+{
+  uint32_t const lits[2] = {a, b};
+  int index;
+  for (index = 0; index < 2; ++index) {
+    struct implication_list* list = &solver->binaries[lits[index]];
+    if (list->count + 1 > list->capacity) {
+      size_t new_capacity = (list->capacity == 0 ? 4 : list->capacity * 2);
+      uint32_t* new_lits = realloc(list->lits, sizeof(*new_lits) * new_capacity);
+      if (new_lits == NULL) {
+        solver->oom = true;
+        return false;
+      }
+      list->capacity = new_capacity;
+      list->lits = new_lits;
+    }
+    list->lits[list->count++] = lits[1 - index];
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_has_binary(struct solver* solver, uint32_t a, uint32_t b)
+{
+  struct implication_list const* list = &solver->binaries[a];
+  uint32_t other = b;
+  size_t index;
+  if (solver->binaries[b].count < list->count) {
+    list = &solver->binaries[b];
+    other = a;
+  }
+  for (index = 0; index < list->count; ++index) {
+    if (list->lits[index] == other)
+      return true;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t const* solver_reason_lits(
+  struct solver* solver, uint32_t ref, uint32_t lit, uint32_t* pair, size_t* size)
+{
+  struct clause_header* clause;
+  if (ref == binary_clause) {
+    *size = 2;
+    if (lit == no_lit)
+      return solver->conflict_lits;
+    pair[0] = lit;
+    pair[1] = solver->reason_lits[lit_var(lit)];
+    return pair;
+  }
+  clause = solver_clause(solver, ref);
+  *size = clause->size;
+  return clause_lits(clause);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool solver_assign(struct solver* solver, uint32_t lit, uint32_t reason)
+{
+  size_t const var = lit_var(lit);
+  enum value value = solver_lit_value(solver, lit);
+  if (value != value_unset)
+    return value == value_true;
+  solver->values[lit] = value_true;
+  solver->values[lit_neg(lit)] = value_false;
+  solver->levels[var] = solver->num_levels;
+  solver->reasons[var] = reason;
+  solver->trail[solver->trail_count++] = lit;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_assign_binary(struct solver* solver, uint32_t lit, uint32_t other)
+{
+  solver_assign(solver, lit, binary_clause);
+  solver->reason_lits[lit_var(lit)] = other;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_decide(struct solver* solver, uint32_t lit)
+{
+  assert(solver_lit_value(solver, lit) == value_unset);
+  solver->trail_lim[solver->num_levels++] = solver->trail_count;
+  solver->num_decisions++;
+  solver_assign(solver, lit, no_clause);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t solver_propagate(struct solver* solver)
+{
+  while (solver->trail_head < solver->trail_count) {
+    uint32_t false_lit;
+    struct watch_list* list = NULL;
+    struct watcher* watchers;
+    size_t i, j;
+
+    // The binary clauses of all assigned literals are propagated before
+    // the next watch list is visited. They need no clause memory and
+    // find most conflicts.
+    while (solver->binary_head < solver->trail_count) {
+      uint32_t const lit = lit_neg(solver->trail[solver->binary_head++]);
+      struct implication_list const* implied = &solver->binaries[lit];
+      for (i = 0; i < implied->count; ++i) {
+        uint32_t const other = implied->lits[i];
+        enum value const value = solver_lit_value(solver, other);
+        if (value == value_true)
+          continue;
+        if (value == value_false) {
+          solver->conflict_lits[0] = other;
+          solver->conflict_lits[1] = lit;
+          solver->trail_head = solver->trail_count;
+          solver->binary_head = solver->trail_count;
+          return binary_clause;
+        }
+        solver_assign_binary(solver, other, lit);
+      }
+    }
+
+    false_lit = lit_neg(solver->trail[solver->trail_head++]);
+    list = &solver->watches[false_lit];
+    watchers = list->watchers;
+    for (i = 0, j = 0; i < list->count; ++i) {
+      uint32_t const index = watchers[i].ref;
+      struct clause_header* clause;
+      uint32_t* vars;
+      uint32_t first, tmp;
+      size_t count, k;
+
+      // The clause is satisfied by its blocker, the arena is not read.
+      if (solver_lit_value(solver, watchers[i].blocker) == value_true) {
+        watchers[j++] = watchers[i];
+        continue;
+      }
+
+      // Fetch the clause of the next watcher while this one is visited.
+      if (i + 1 < list->count)
+        PREFETCH(solver->arena + watchers[i + 1].ref);
+
+      clause = solver_clause(solver, index);
+      count = clause->size;
+      vars = clause_lits(clause);
+
+      // Make sure the false literal is the second watch.
+      if (vars[0] == false_lit) {
+        vars[0] = vars[1];
+        vars[1] = false_lit;
+      }
+
+      // The clause is satisfied by the other watch, which becomes the
+      // blocker.
+      first = vars[0];
+      if (first != watchers[i].blocker && solver_lit_value(solver, first) == value_true) {
+        watchers[j].ref = index;
+        watchers[j].blocker = first;
+        j++;
+        continue;
+      }
+
+      // Look for a literal that is not false to watch instead.
+      for (k = 2; k < count; ++k) {
+        if (solver_lit_value(solver, vars[k]) != value_false)
+          break;
+      }
+      if (k < count) {
+        tmp = vars[1];
+        vars[1] = vars[k];
+        vars[k] = tmp;
+        if (!solver_watch(solver, vars[1], index, first)) {
+          // Keep the remaining watches, the search is aborted anyway.
+          for (; i < list->count; ++i)
+            watchers[j++] = watchers[i];
+          list->count = j;
+          return index;
+        }
+        continue;
+      }
+
+      // The clause is unit or empty under the current assignment.
+      watchers[j].ref = index;
+      watchers[j].blocker = first;
+      j++;
+      if (!solver_assign(solver, first, index)) {
+        for (++i; i < list->count; ++i)
+          watchers[j++] = watchers[i];
+        list->count = j;
+        solver->trail_head = solver->trail_count;
+        solver->binary_head = solver->trail_count;
+        return index;
+      }
+    }
+    list->count = j;
+  }
+  return no_clause;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_backtrack(struct solver* solver, size_t level)
+{
+  size_t mark;
+  if (level >= solver->num_levels)
+    return;
+  mark = solver->trail_lim[level];
+  while (solver->trail_count > mark) {
+    uint32_t const lit = solver->trail[--solver->trail_count];
+    if (solver->options->phase_saving)
+      solver->phases[lit_var(lit)] = lit_positive(lit);
+    solver->values[lit] = value_unset;
+    solver->values[lit_neg(lit)] = value_unset;
+    solver_heap_insert(solver, lit_var(lit));
+  }
+  solver->trail_head = mark;
+  solver->binary_head = mark;
+  solver->num_levels = level;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_heap_up(struct solver* solver, size_t pos)
+{
+  size_t const var = solver->heap[pos];
+  double const activity = solver->activity[var];
+  while (pos > 0) {
+    size_t const parent = (pos - 1) / 2;
+    if (solver->activity[solver->heap[parent]] >= activity)
+      break;
+    solver->heap[pos] = solver->heap[parent];
+    solver->heap_index[solver->heap[pos]] = pos;
+    pos = parent;
+  }
+  solver->heap[pos] = var;
+  solver->heap_index[var] = pos;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_heap_down(struct solver* solver, size_t pos)
+{
+  size_t const var = solver->heap[pos];
+  double const activity = solver->activity[var];
+  while (true) {
+    size_t child = pos * 2 + 1;
+    if (child >= solver->heap_count)
+      break;
+    if (child + 1 < solver->heap_count &&
+        solver->activity[solver->heap[child + 1]] > solver->activity[solver->heap[child]])
+      child++;
+    if (solver->activity[solver->heap[child]] <= activity)
+      break;
+    solver->heap[pos] = solver->heap[child];
+    solver->heap_index[solver->heap[pos]] = pos;
+    pos = child;
+  }
+  solver->heap[pos] = var;
+  solver->heap_index[var] = pos;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_heap_insert(struct solver* solver, size_t var)
+{
+  if (solver->heap_index[var] != not_in_heap)
+    return;
+  solver->heap[solver->heap_count] = var;
+  solver->heap_index[var] = solver->heap_count;
+  solver_heap_up(solver, solver->heap_count++);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_heap_pop(struct solver* solver)
+{
+  size_t const var = solver->heap[0];
+  assert(solver->heap_count > 0);
+  solver->heap_index[var] = not_in_heap;
+  if (--solver->heap_count > 0) {
+    solver->heap[0] = solver->heap[solver->heap_count];
+    solver->heap_index[solver->heap[0]] = 0;
+    solver_heap_down(solver, 0);
+  }
+  return var;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_bump(struct solver* solver, size_t var)
+{
+  solver->activity[var] += solver->var_inc;
+  if (solver->activity[var] > var_activity_limit) {
+    // Rescale all activities, this keeps their order.
+    size_t index;
+    for (index = 0; index < solver->num_vars; ++index) {
+      solver->activity[index] /= var_activity_limit;
+    }
+    solver->var_inc /= var_activity_limit;
+  }
+  if (solver->heap_index[var] != not_in_heap)
+    solver_heap_up(solver, solver->heap_index[var]);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_decay(struct solver* solver)
+{
+  solver->var_inc /= var_decay;
+  solver->clause_inc /= clause_decay;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t solver_pick(struct solver* solver)
+{
+  while (solver->heap_count > 0) {
+    size_t const var = solver_heap_pop(solver);
+    if (solver->values[var * 2] == value_unset)
+      return var;
+  }
+  return solver->num_vars;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool input_load(
+  struct input* input, FILE* fp, unsigned char const* prefix, size_t prefix_size)
+{
+  size_t capacity = 0;
+  input->data = NULL;
+  input->size = 0;
+  input->map = NULL;
+  input->map_size = 0;
+
+#ifndef _MSC_VER
+  if (prefix_size == 0) {
+    // Map regular files from the current position to their end. The
+    // mapping must start at a page boundary.
+    struct stat st;
+    off_t const pos = ftello(fp);
+    if (pos >= 0 && fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > pos) {
+      off_t const page = (off_t) sysconf(_SC_PAGESIZE);
+      off_t const start = pos - pos % page;
+      void* map = mmap(NULL, (size_t) (st.st_size - start), PROT_READ, MAP_PRIVATE, fileno(fp), start);
+      if (map != MAP_FAILED) {
+        posix_madvise(map, (size_t) (st.st_size - start), POSIX_MADV_SEQUENTIAL);
+        input->map = map;
+        input->map_size = (size_t) (st.st_size - start);
+        input->data = (char*) map + (pos - start);
+        input->size = (size_t) (st.st_size - pos);
+        fseeko(fp, 0, SEEK_END);
+        return true;
+      }
+    }
+  }
+#endif
+
+  if (prefix_size > 0) {
+    capacity = input_blocksize;
+    input->data = malloc(capacity);
+    if (input->data == NULL) {
+      errno = ENOMEM;
+      return false;
+    }
+    memcpy(input->data, prefix, prefix_size);
+    input->size = prefix_size;
+  }
+
+  while (true) {
+    size_t count;
+    if (input->size + input_blocksize > capacity) {
+      size_t new_capacity = (capacity == 0 ? input_blocksize : capacity * 2);
+      char* new_data = realloc(input->data, new_capacity);
+      if (new_data == NULL) {
+        input_free(input);
+        errno = ENOMEM;
+        return false;
+      }
+      capacity = new_capacity;
+      input->data = new_data;
+    }
+    count = fread(input->data + input->size, 1, capacity - input->size, fp);
+    input->size += count;
+    if (count == 0)
+      break;
+  }
+  if (ferror(fp)) {
+    input_free(input);
+    errno = EIO;
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void input_free(struct input* input)
+{
+#ifndef _MSC_VER
+  if (input->map) {
+    munmap(input->map, input->map_size);
+    input->map = NULL;
+    input->data = NULL;
+  }
+#endif
+  free(input->data);
+  input->data = NULL;
+  input->size = 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static enum input_format input_detect(unsigned char const* magic, size_t size)
+{
+  if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    return input_gzip;
+  if (size >= 6 && memcmp(magic, "\xfd" "7zXZ\0", 6) == 0)
+    return input_xz;
+  if (size >= 3 && memcmp(magic, "BZh", 3) == 0)
+    return input_bzip2;
+  return input_plain;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static const char* input_format_name(enum input_format format)
+{
+  switch (format) {
+    case input_gzip: return "gzip";
+    case input_xz: return "xz";
+    case input_bzip2: return "bzip2";
+    case input_plain:
+    default: return "plain";
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool decoder_init(
+  struct decoder* decoder, enum input_format format, FILE* fp,
+  unsigned char const* prefix, size_t prefix_size)
+{
+  bool result = false;
+
+  decoder->format = format;
+  decoder->fp = fp;
+  decoder->prefix = prefix;
+  decoder->prefix_size = prefix_size;
+  decoder->prefix_pos = 0;
+  decoder->eof = false;
+  decoder->finished = false;
+  decoder->in = malloc(input_blocksize);
+  if (decoder->in == NULL) {
+    errno = ENOMEM;
+    return false;
+  }
+
+  errno = EINVAL;
+  switch (format) {
+#ifdef DPLL_HAVE_ZLIB
+    case input_gzip:
+      memset(&decoder->stream.gzip, 0, sizeof(decoder->stream.gzip));
+      result = inflateInit2(&decoder->stream.gzip, 15 + 16) == Z_OK;
+      break;
+#endif
+#ifdef DPLL_HAVE_LZMA
+    case input_xz: {
+      lzma_stream const init = LZMA_STREAM_INIT;
+      decoder->stream.xz = init;
+      result = lzma_stream_decoder(&decoder->stream.xz, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+      break;
+    }
+#endif
+#ifdef DPLL_HAVE_BZLIB
+    case input_bzip2:
+      memset(&decoder->stream.bzip2, 0, sizeof(decoder->stream.bzip2));
+      result = BZ2_bzDecompressInit(&decoder->stream.bzip2, 0, 0) == BZ_OK;
+      break;
+#endif
+    default:
+      free(decoder->in);
+      decoder->in = NULL;
+      return false;
+  }
+  if (!result) {
+    free(decoder->in);
+    decoder->in = NULL;
+    errno = ENOMEM;
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void decoder_free(struct decoder* decoder)
+{
+  switch (decoder->format) {
+#ifdef DPLL_HAVE_ZLIB
+    case input_gzip:
+      inflateEnd(&decoder->stream.gzip);
+      break;
+#endif
+#ifdef DPLL_HAVE_LZMA
+    case input_xz:
+      lzma_end(&decoder->stream.xz);
+      break;
+#endif
+#ifdef DPLL_HAVE_BZLIB
+    case input_bzip2:
+      BZ2_bzDecompressEnd(&decoder->stream.bzip2);
+      break;
+#endif
+    default:
+      break;
+  }
+  free(decoder->in);
+  decoder->in = NULL;
+}
+
+#if defined(DPLL_HAVE_ZLIB) || defined(DPLL_HAVE_LZMA) || defined(DPLL_HAVE_BZLIB)
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static size_t decoder_fill(struct decoder* decoder)
+{
+  size_t count = 0;
+  if (decoder->prefix_pos < decoder->prefix_size) {
+    count = decoder->prefix_size - decoder->prefix_pos;
+    memcpy(decoder->in, decoder->prefix + decoder->prefix_pos, count);
+    decoder->prefix_pos = decoder->prefix_size;
+  }
+  if (!decoder->eof) {
+    count += fread(decoder->in + count, 1, input_blocksize - count, decoder->fp);
+    if (count == 0)
+      decoder->eof = true;
+  }
+  return count;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static long decoder_read(struct decoder* decoder, char* out, size_t size)
+{
+  if (decoder->finished)
+    return 0;
+
+  switch (decoder->format) {
+#ifdef DPLL_HAVE_ZLIB
+    case input_gzip: {
+      z_stream* stream = &decoder->stream.gzip;
+      stream->next_out = (Bytef*) out;
+      stream->avail_out = (uInt) size;
+      while (stream->avail_out == size && !decoder->finished) {
+        int ret;
+        if (stream->avail_in == 0) {
+          stream->next_in = decoder->in;
+          stream->avail_in = (uInt) decoder_fill(decoder);
+        }
+        ret = inflate(stream, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+          // Concatenated members are decompressed one after the other.
+          if (stream->avail_in == 0) {
+            stream->next_in = decoder->in;
+            stream->avail_in = (uInt) decoder_fill(decoder);
+          }
+          if (stream->avail_in == 0)
+            decoder->finished = true;
+          else if (inflateReset(stream) != Z_OK)
+            return -1;
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+          return -1;
+        else if (stream->avail_in == 0 && decoder->eof && stream->avail_out == size)
+          return -1;  // truncated
+      }
+      return (long) (size - stream->avail_out);
+    }
+#endif
+#ifdef DPLL_HAVE_LZMA
+    case input_xz: {
+      lzma_stream* stream = &decoder->stream.xz;
+      stream->next_out = (uint8_t*) out;
+      stream->avail_out = size;
+      while (stream->avail_out == size && !decoder->finished) {
+        lzma_ret ret;
+        if (stream->avail_in == 0 && !decoder->eof) {
+          stream->next_in = decoder->in;
+          stream->avail_in = decoder_fill(decoder);
+        }
+        ret = lzma_code(stream, decoder->eof ? LZMA_FINISH : LZMA_RUN);
+        if (ret == LZMA_STREAM_END)
+          decoder->finished = true;
+        else if (ret != LZMA_OK)
+          return -1;
+      }
+      return (long) (size - stream->avail_out);
+    }
+#endif
+#ifdef DPLL_HAVE_BZLIB
+    case input_bzip2: {
+      bz_stream* stream = &decoder->stream.bzip2;
+      stream->next_out = out;
+      stream->avail_out = (unsigned) size;
+      while (stream->avail_out == size && !decoder->finished) {
+        int ret;
+        if (stream->avail_in == 0) {
+          stream->next_in = (char*) decoder->in;
+          stream->avail_in = (unsigned) decoder_fill(decoder);
+        }
+        ret = BZ2_bzDecompress(stream);
+        if (ret == BZ_STREAM_END) {
+          // Concatenated streams are decompressed one after the other.
+          char* next_in = stream->next_in;
+          unsigned avail_in = stream->avail_in;
+          if (avail_in == 0) {
+            next_in = (char*) decoder->in;
+            avail_in = (unsigned) decoder_fill(decoder);
+          }
+          if (avail_in == 0) {
+            decoder->finished = true;
+            break;
+          }
+          BZ2_bzDecompressEnd(stream);
+          if (BZ2_bzDecompressInit(stream, 0, 0) != BZ_OK)
+            return -1;
+          stream->next_in = next_in;
+          stream->avail_in = avail_in;
+          stream->next_out = out + (size - stream->avail_out);
+        }
+        else if (ret != BZ_OK)
+          return -1;
+        else if (stream->avail_in == 0 && decoder->eof && stream->avail_out == size)
+          return -1;  // truncated
+      }
+      return (long) (size - stream->avail_out);
+    }
+#endif
+    default:
+      (void) out;
+      (void) size;
+      return -1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static char* block_queue_decode(struct block_queue* queue, size_t* size, bool* failed)
+{
+  char* block = malloc(input_blocksize);
+  long count = 1;
+  *size = 0;
+  *failed = false;
+  if (block == NULL) {
+    *failed = true;
+    return NULL;
+  }
+  while (*size < input_blocksize) {
+    count = decoder_read(queue->decoder, block + *size, input_blocksize - *size);
+    if (count <= 0)
+      break;
+    *size += (size_t) count;
+  }
+  if (count < 0 || *size == 0) {
+    *failed = (count < 0);
+    free(block);
+    return NULL;
+  }
+  return block;
+}
+
+#ifndef _MSC_VER
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void* block_queue_thread(void* arg)
+{
+  struct block_queue* queue = arg;
+  while (true) {
+    size_t size;
+    bool failed;
+    char* block = block_queue_decode(queue, &size, &failed);
+
+    pthread_mutex_lock(&queue->mutex);
+    while (block && queue->count == INPUT_QUEUE_SIZE && !queue->cancel)
+      pthread_cond_wait(&queue->cond, &queue->mutex);
+    if (block == NULL || queue->cancel) {
+      queue->done = true;
+      queue->failed = failed;
+      pthread_cond_broadcast(&queue->cond);
+      pthread_mutex_unlock(&queue->mutex);
+      free(block);
+      return NULL;
+    }
+    queue->blocks[(queue->head + queue->count) % INPUT_QUEUE_SIZE] = block;
+    queue->sizes[(queue->head + queue->count) % INPUT_QUEUE_SIZE] = size;
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+  }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static char* block_queue_pop(struct block_queue* queue, size_t* size, bool* failed)
+{
+  char* block = NULL;
+  if (!queue->threaded)
+    return block_queue_decode(queue, size, failed);
+
+  *failed = false;
+#ifndef _MSC_VER
+  pthread_mutex_lock(&queue->mutex);
+  while (queue->count == 0 && !queue->done)
+    pthread_cond_wait(&queue->cond, &queue->mutex);
+  *failed = queue->failed;
+  if (queue->count > 0 && !queue->failed) {
+    block = queue->blocks[queue->head];
+    *size = queue->sizes[queue->head];
+    queue->head = (queue->head + 1) % INPUT_QUEUE_SIZE;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+#endif
+  return block;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool parse_compressed(
+  struct clause_set* set, FILE* fp, enum input_format format,
+  unsigned char const* magic, size_t magic_size)
+{
+  struct decoder decoder;
+  struct block_queue queue;
+  struct parse_chunk chunk;
+  struct clause_builder builder;
+  char* pending = NULL;
+  size_t pending_size = 0, pending_capacity = 0;
+  bool header = false, result = true;
+#ifndef _MSC_VER
+  pthread_t thread;
+#endif
+
+  if (!decoder_init(&decoder, format, fp, magic, magic_size)) {
+    if (errno == EINVAL)
+      dpll_puterr("clause_set_parse(): %s input is not supported by this build", input_format_name(format));
+    else
+      dpll_puterr("clause_set_parse(): could not read input");
+    return false;
+  }
+
+  queue.decoder = &decoder;
+  queue.head = 0;
+  queue.count = 0;
+  queue.done = false;
+  queue.failed = false;
+  queue.cancel = false;
+  queue.threaded = false;
+#ifndef _MSC_VER
+  pthread_mutex_init(&queue.mutex, NULL);
+  pthread_cond_init(&queue.cond, NULL);
+  queue.threaded = pthread_create(&thread, NULL, block_queue_thread, &queue) == 0;
+#endif
+
+  clause_set_init(&chunk.local);
+  chunk.set = set;
+  chunk.first = set->count;
+  chunk.num_vars = 0;
+  chunk.error = parse_ok;
+  chunk.warning = false;
+  clause_builder_init(&builder, set);
+
+  // Parse the complete lines of the decompressed input, the incomplete
+  // last line is kept in #pending until the next block arrives.
+  while (true) {
+    struct cursor cur;
+    char const* end;
+    size_t size = 0;
+    bool failed;
+    char* block = block_queue_pop(&queue, &size, &failed);
+
+    if (failed) {
+      errno = EIO;
+      dpll_puterr("clause_set_parse(): could not decompress %s input", input_format_name(format));
+      result = false;
+      break;
+    }
+    if (block) {
+      if (pending_size + size > pending_capacity) {
+        size_t new_capacity = (pending_capacity == 0 ? input_blocksize : pending_capacity * 2);
+        char* new_pending;
+        while (new_capacity < pending_size + size)
+          new_capacity *= 2;
+        new_pending = realloc(pending, new_capacity);
+        if (new_pending == NULL) {
+          free(block);
+          errno = ENOMEM;
+          dpll_puterr("clause_set_parse(): could not read input");
+          result = false;
+          break;
+        }
+        pending_capacity = new_capacity;
+        pending = new_pending;
+      }
+      memcpy(pending + pending_size, block, size);
+      pending_size += size;
+      free(block);
+    }
+
+    cur.pos = pending;
+    cur.end = pending + pending_size;
+    if (!header) {
+      if (block && !header_complete(&cur))
+        continue;
+      if (!parse_header(set, &cur, &chunk.num_vars)) {
+        result = false;
+        break;
+      }
+      header = true;
+    }
+
+    end = cur.end;
+    if (block) {
+      while (end > cur.pos && end[-1] != '\n')
+        end--;
+    }
+    chunk.cur.pos = cur.pos;
+    chunk.cur.end = end;
+    parse_clauses(&chunk, &builder);
+    if (!parse_report(&chunk, 0)) {
+      result = false;
+      break;
+    }
+    chunk.warning = false;
+
+    pending_size = (size_t) (cur.end - end);
+    if (pending_size > 0)
+      memmove(pending, end, pending_size);
+    if (block == NULL)
+      break;
+  }
+
+#ifndef _MSC_VER
+  pthread_mutex_lock(&queue.mutex);
+  queue.cancel = true;
+  pthread_cond_broadcast(&queue.cond);
+  pthread_mutex_unlock(&queue.mutex);
+  if (queue.threaded)
+    pthread_join(thread, NULL);
+  while (queue.count > 0) {
+    free(queue.blocks[queue.head]);
+    queue.head = (queue.head + 1) % INPUT_QUEUE_SIZE;
+    queue.count--;
+  }
+  pthread_cond_destroy(&queue.cond);
+  pthread_mutex_destroy(&queue.mutex);
+#endif
+  clause_builder_free(&builder);
+  decoder_free(&decoder);
+  free(pending);
+
+  // Not releasing the unused capacity is no error.
+  if (result)
+    clause_set_shrink_to_fit(set);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool read_long_long(struct cursor* cur, long long* result)
+{
+  char const* pos = cur->pos;
+  char const* end = cur->end;
+  char const* start;
+  unsigned long long value = 0;
+  bool negative = false;
+
+  if (pos < end && *pos == '-') {
+    negative = true;
+    pos++;
+  }
+  if (pos == end || (unsigned) (*pos - '0') > 9) {
+    errno = EILSEQ;
+    return false;
+  }
+
+  // Accumulate the digits without an overflow check for every digit,
+  // 18 decimal digits always fit into a long long.
+  start = pos;
+  do {
+    value = value * 10 + (unsigned) (*pos - '0');
+    pos++;
+  } while (pos < end && (unsigned) (*pos - '0') <= 9);
+  if (pos - start > 18) {
+    errno = ERANGE;
+    return false;
+  }
+
+  cur->pos = pos;
+  *result = negative ? -(long long) value : (long long) value;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void skip_whitespace(struct cursor* cur)
+{
+  char const* pos = cur->pos;
+  while (pos < cur->end && (*pos == ' ' || *pos == '\t' || *pos == '\r' ||
+      *pos == '\v' || *pos == '\f'))
+    pos++;
+  cur->pos = pos;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool skip_char(struct cursor* cur, int c)
+{
+  if (cur->pos == cur->end)
+    return c == EOF;
+  if (*cur->pos != c)
+    return false;
+  cur->pos++;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void skip_line(struct cursor* cur)
+{
+  char const* newline = memchr(cur->pos, '\n', (size_t) (cur->end - cur->pos));
+  cur->pos = (newline ? newline + 1 : cur->end);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool match_token(struct cursor* cur, const char* str)
+{
+  size_t const length = strlen(str);
+  if ((size_t) (cur->end - cur->pos) < length || memcmp(cur->pos, str, length) != 0)
+    return false;
+  cur->pos += length;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static uint32_t solver_phase_lit(struct solver* solver, size_t var)
+{
+  uint32_t const lit = (uint32_t) var * 2;
+  return solver->phases[var] ? lit : lit_neg(lit);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_update_target(struct solver* solver)
+{
+  size_t const size = solver->trail_lim[solver->num_levels - 1];
+  size_t index;
+  if (size <= solver->target_size)
+    return;
+  for (index = 0; index < size; ++index) {
+    uint32_t const lit = solver->trail[index];
+    solver->target_phases[lit_var(lit)] = lit_positive(lit);
+  }
+  solver->target_size = size;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void solver_rephase(struct solver* solver)
+{
+  memcpy(solver->phases, solver->target_phases, sizeof(*solver->phases) * solver->num_vars);
+  solver->target_size = 0;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool simplifier_init(
+  struct simplifier* simp, struct clause_set const* set,
+  struct clause_set_solve_options const* options)
+{
+  size_t index;
+
+  simp->num_vars = set->num_vars;
+  simp->options = options;
+  simp->clauses = NULL;
+  simp->count = 0;
+  simp->capacity = 0;
+  simp->lits = NULL;
+  simp->num_lits = 0;
+  simp->lits_capacity = 0;
+  simp->occs = calloc(set->num_vars * 2, sizeof(*simp->occs));
+  simp->num_occs = calloc(set->num_vars * 2, sizeof(*simp->num_occs));
+  simp->queue = NULL;
+  simp->queue_count = 0;
+  simp->queue_capacity = 0;
+  simp->num_subsumed = 0;
+  simp->num_strengthened = 0;
+  simp->pure = NULL;
+  simp->pure_count = 0;
+  simp->pure_capacity = 0;
+  simp->num_pure = 0;
+  simp->values = malloc(sizeof(*simp->values) * set->num_vars * 2);
+  simp->units = malloc(sizeof(*simp->units) * set->num_vars);
+  simp->units_count = 0;
+  simp->units_head = 0;
+  simp->eliminated = calloc(set->num_vars, sizeof(*simp->eliminated));
+  simp->num_eliminated = 0;
+  simp->num_substituted = 0;
+  simp->heap = malloc(sizeof(*simp->heap) * set->num_vars);
+  simp->heap_count = 0;
+  simp->heap_index = malloc(sizeof(*simp->heap_index) * set->num_vars);
+  simp->marks = calloc(set->num_vars * 2, sizeof(*simp->marks));
+  simp->resolvent = malloc(sizeof(*simp->resolvent) * set->num_vars);
+  simp->stack = NULL;
+  simp->stack_count = 0;
+  simp->stack_capacity = 0;
+  simp->unsat = false;
+  simp->oom = false;
+  if (set->num_vars > 0 && (!simp->occs || !simp->num_occs || !simp->values ||
+      !simp->units || !simp->eliminated || !simp->heap || !simp->heap_index ||
+      !simp->marks || !simp->resolvent)) {
+    return false;
+  }
+  memset(simp->values, value_unset, sizeof(*simp->values) * set->num_vars * 2);
+  for (index = 0; index < set->num_vars; ++index) {
+    simp->heap_index[index] = not_in_heap;
+  }
+
+  for (index = 0; index < set->count && !simp->unsat; ++index) {
+    uint32_t const* lits = set->lits + set->offsets[index];
+    size_t const count = set->offsets[index + 1] - set->offsets[index];
+    size_t i, size = 0;
+    bool tautology = false;
+
+    // Drop duplicate literals and tautologies, the clause_set does not
+    // guarantee their absence.
+    for (i = 0; i < count; ++i) {
+      if (simp->marks[lit_neg(lits[i])])
+        tautology = true;
+      else if (!simp->marks[lits[i]]) {
+        simp->marks[lits[i]] = true;
+        simp->resolvent[size++] = lits[i];
+      }
+    }
+    for (i = 0; i < size; ++i) {
+      simp->marks[simp->resolvent[i]] = false;
+    }
+    if (!tautology && !simplifier_add_clause(simp, simp->resolvent, size))
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_free(struct simplifier* simp)
+{
+  size_t index;
+  if (simp->occs) {
+    for (index = 0; index < simp->num_vars * 2; ++index) {
+      free(simp->occs[index].clauses);
+    }
+  }
+  free(simp->clauses);
+  free(simp->lits);
+  free(simp->occs);
+  free(simp->num_occs);
+  free(simp->queue);
+  free(simp->pure);
+  free(simp->values);
+  free(simp->units);
+  free(simp->eliminated);
+  free(simp->heap);
+  free(simp->heap_index);
+  free(simp->marks);
+  free(simp->resolvent);
+  free(simp->stack);
+  simp->clauses = NULL;
+  simp->lits = NULL;
+  simp->occs = NULL;
+  simp->num_occs = NULL;
+  simp->queue = NULL;
+  simp->pure = NULL;
+  simp->values = NULL;
+  simp->units = NULL;
+  simp->eliminated = NULL;
+  simp->heap = NULL;
+  simp->heap_index = NULL;
+  simp->marks = NULL;
+  simp->resolvent = NULL;
+  simp->stack = NULL;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static bool simplifier_add_clause(
+  struct simplifier* simp, uint32_t const* lits, size_t count)
+{
+  struct simplifier_clause* clause;
+  size_t index, size = 0;
+
+  if (simp->count + 1 > simp->capacity) {
+    size_t new_capacity = (simp->capacity == 0 ? clause_set_chunksize : simp->capacity * 2);
+    struct simplifier_clause* new_clauses = realloc(simp->clauses, sizeof(*new_clauses) * new_capacity);
+    if (new_clauses == NULL) {
+      simp->oom = true;
+      return false;
+    }
+    simp->capacity = new_capacity;
+    simp->clauses = new_clauses;
+  }
+  if (simp->num_lits + count > simp->lits_capacity) {
+    size_t new_capacity = (simp->lits_capacity == 0 ?
+      clause_set_chunksize * clause_chunksize : simp->lits_capacity * 2);
+    uint32_t* new_lits;
+    if (new_capacity < simp->num_lits + count)
+      new_capacity = simp->num_lits + count;
+    new_lits = realloc(simp->lits, sizeof(*new_lits) * new_capacity);
+    if (new_lits == NULL) {
+      simp->oom = true;
+      return false;
+    }
+    simp->lits_capacity = new_capacity;
+    simp->lits = new_lits;
+  }
+
+  // Leave out the false literals, a true literal satisfies the clause.
+  for (index = 0; index < count; ++index) {
+    unsigned char const value = simp->values[lits[index]];
+    if (value == value_true)
+      return true;
+    if (value == value_unset)
+      simp->lits[simp->num_lits + size++] = lits[index];
+  }
+  if (size == 0) {
+    simp->unsat = true;
+    return true;
+  }
+  if (size == 1) {
+    simplifier_assign(simp, simp->lits[simp->num_lits]);
+    return true;
+  }
+
+  for (index = 0; index < size; ++index) {
+    uint32_t const lit = simp->lits[simp->num_lits + index];
+    struct occurrence_list* list = &simp->occs[lit];
+    if (list->count + 1 > list->capacity) {
+      size_t new_capacity = (list->capacity == 0 ? 4 : list->capacity * 2);
+      uint32_t* new_clauses = realloc(list->clauses, sizeof(*new_clauses) * new_capacity);
+      if (new_clauses == NULL) {
+        simp->oom = true;
+        return false;
+      }
+      list->capacity = new_capacity;
+      list->clauses = new_clauses;
+    }
+    list->clauses[list->count++] = (uint32_t) simp->count;
+    simp->num_occs[lit]++;
+    simplifier_touch(simp, lit_var(lit));
+  }
+  clause = &simp->clauses[simp->count++];
+  clause->offset = simp->num_lits;
+  clause->signature = simplifier_signature(simp->lits + simp->num_lits, size);
+  clause->size = (uint32_t) size;
+  clause->removed = false;
+  clause->queued = false;
+  simp->num_lits += size;
+  return simplifier_queue(simp, (uint32_t) (simp->count - 1));
+}
 
-// The increment for the capacity of a clause and clause_set.
-static size_t const clause_chunksize = 16;
-static size_t const clause_set_chunksize = 128;
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_remove_clause(struct simplifier* simp, uint32_t index)
+{
+  struct simplifier_clause* clause = &simp->clauses[index];
+  uint32_t const* lits = simp->lits + clause->offset;
+  uint32_t i;
+  clause->removed = true;
+  for (i = 0; i < clause->size; ++i) {
+    simplifier_drop_occ(simp, lits[i]);
+    simplifier_touch(simp, lit_var(lits[i]));
+  }
+}
 
-// Read a \c long \c long from a file and return true on success,
-// false on error. Requires the file to be positioned immediately
-// at the ASCII integer. Set #errno when false is returned.
-//
-// #ERANGE: If the ASCII integer in the file is too large.
-// #EILSEQ: If the file does not point to a digit or a minus
-//   followed by a digit.
-static bool read_long_long(FILE* fp, long long* result);
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_assign(struct simplifier* simp, uint32_t lit)
+{
+  unsigned char const value = simp->values[lit];
+  if (value != value_unset) {
+    if (value == value_false)
+      simp->unsat = true;
+    return;
+  }
+  simp->values[lit] = value_true;
+  simp->values[lit_neg(lit)] = value_false;
+  simp->units[simp->units_count++] = lit;
+}
 
-// Skip non-newline whitespace in the file.
-static void skip_whitespace(FILE* fp);
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_propagate(struct simplifier* simp)
+{
+  while (simp->units_head < simp->units_count && !simp->unsat) {
+    uint32_t const lit = simp->units[simp->units_head++];
+    uint32_t const false_lit = lit_neg(lit);
+    struct occurrence_list* list = &simp->occs[lit];
+    size_t index;
 
-// Skip a specific character if it is the character currently pointed
-// to in the file. Return true if the character was skipped, false if not.
-static bool skip_char(FILE* fp, int c);
+    // The clauses with the literal are satisfied.
+    for (index = 0; index < list->count; ++index) {
+      if (!simp->clauses[list->clauses[index]].removed)
+        simplifier_remove_clause(simp, list->clauses[index]);
+    }
 
-// Match the specified text from the current position in the file.
-static bool match_token(FILE* fp, const char* str);
+    // The negation is removed from the other clauses, which may become
+    // unit. The remaining literal of a unit clause is assigned.
+    list = &simp->occs[false_lit];
+    for (index = 0; index < list->count && !simp->unsat && !simp->oom; ++index) {
+      if (!simp->clauses[list->clauses[index]].removed)
+        simplifier_strengthen(simp, list->clauses[index], false_lit);
+    }
 
-// Internal procedure to solve a clause_set.
-static bool _clause_set_solve(
-  struct clause_set* set, bool* out_values, bool* pre_cond, long long last_var,
-  clause_set_solve_callback callback, void* userdata, bool* sat, bool* search);
+    for (index = 0; index < 2; ++index) {
+      list = &simp->occs[index == 0 ? lit : false_lit];
+      free(list->clauses);
+      list->clauses = NULL;
+      list->count = 0;
+      list->capacity = 0;
+    }
+  }
+}
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-char dpll_errinfo[BUFSIZ] = {0};
+static void simplifier_run(struct simplifier* simp)
+{
+  simplifier_propagate(simp);
+  simplifier_subsume_all(simp);
+  if (simp->options->substitute && !simp->unsat && !simp->oom) {
+    simplifier_substitute(simp);
+    simplifier_subsume_all(simp);
+  }
+  if (simp->options->pure && !simp->unsat && !simp->oom)
+    simplifier_remove_pure(simp);
+  if (!simp->options->eliminate)
+    return;
+  while (simp->heap_count > 0 && !simp->unsat && !simp->oom) {
+    size_t const var = simplifier_heap_pop(simp);
+    if (simp->values[var * 2] == value_unset && !simp->eliminated[var]) {
+      simplifier_eliminate(simp, var);
+      simplifier_subsume_all(simp);
+    }
+  }
+}
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void dpll_puterr(const char* fmt, ...)
+static void simplifier_remove_pure(struct simplifier* simp)
 {
-  va_list args;
-  va_start(args, fmt);
-  vsnprintf(dpll_errinfo, BUFSIZ, fmt, args);
-  va_end(args);
+  size_t var;
+  for (var = 0; var < simp->num_vars && !simp->unsat && !simp->oom; ++var) {
+    simplifier_check_pure(simp, var);
+  }
+  while (simp->pure_count > 0 && !simp->unsat && !simp->oom) {
+    simplifier_check_pure(simp, simp->pure[--simp->pure_count]);
+  }
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void clause_init(struct clause* clause)
+static void simplifier_check_pure(struct simplifier* simp, size_t var)
 {
-  clause->count = 0;
-  clause->capacity = 0;
-  clause->vars = NULL;
-  clause->eliminate = NULL;
+  uint32_t const lit = (uint32_t) var * 2;
+  size_t const pos = simp->num_occs[lit];
+  size_t const neg = simp->num_occs[lit_neg(lit)];
+  if (simp->eliminated[var] || simp->values[lit] != value_unset || (pos == 0) == (neg == 0))
+    return;
+
+  // The clauses of a pure literal are satisfied by it without falsifying
+  // any other clause. Their removal may make more literals pure.
+  simplifier_assign(simp, pos > 0 ? lit : lit_neg(lit));
+  simp->num_pure++;
+  simplifier_propagate(simp);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void clause_free(struct clause* clause)
+static void simplifier_drop_occ(struct simplifier* simp, uint32_t lit)
 {
-  free(clause->vars);
-  free(clause->eliminate);
-  clause_init(clause);
+  if (--simp->num_occs[lit] > 0 || !simp->options->pure)
+    return;
+  if (simp->pure_count + 1 > simp->pure_capacity) {
+    size_t new_capacity = (simp->pure_capacity == 0 ? 1024 : simp->pure_capacity * 2);
+    uint32_t* new_pure = realloc(simp->pure, sizeof(*new_pure) * new_capacity);
+    if (new_pure == NULL) {
+      simp->oom = true;
+      return;
+    }
+    simp->pure_capacity = new_capacity;
+    simp->pure = new_pure;
+  }
+  simp->pure[simp->pure_count++] = (uint32_t) lit_var(lit);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-int clause_add(struct clause* clause, long long const var)
+static void simplifier_substitute(struct simplifier* simp)
 {
-  // Check if the literal already exist.
-  size_t index;
-  for (index = 0; index < clause->count; ++index) {
-    if (clause->vars[index] == var)
-      return 1;
+  size_t const num_lits = simp->num_vars * 2;
+  size_t* order = malloc(sizeof(*order) * num_lits);
+  size_t* low = malloc(sizeof(*low) * num_lits);
+  uint32_t* repr = malloc(sizeof(*repr) * num_lits);
+  uint32_t* component = malloc(sizeof(*component) * num_lits);
+  struct tarjan_frame* frames = malloc(sizeof(*frames) * num_lits);
+  size_t component_count = 0, counter = 0, count, index;
+  uint32_t root;
+
+  if (num_lits > 0 && (!order || !low || !repr || !component || !frames)) {
+    simp->oom = true;
+    goto cleanup;
+  }
+  for (index = 0; index < num_lits; ++index) {
+    order[index] = 0;
+    repr[index] = no_lit;
   }
 
-  // Resize the data if necessary.
-  if (clause->count + 1 > clause->capacity) {
-    size_t new_capacity = clause->capacity + clause_chunksize;
-    long long* new_vars = realloc(clause->vars, sizeof(*new_vars) * new_capacity);
-    int* new_eliminate = realloc(clause->eliminate, sizeof(*new_eliminate) * new_capacity);
-    if (new_vars == NULL || new_eliminate == NULL) {
-      // Memory error. We free the clause so no invalid frees can happen
-      // if a realloc() call succeeded for one of the memory blocks and
-      // moved it to another location.
-      free(new_vars);
-      free(new_eliminate);
-      clause_free(clause);
-      return 0;
+  // Tarjan's algorithm on the implication graph of the binary clauses,
+  // with an explicit stack of frames instead of recursion. A literal u
+  // implies w if there is a binary clause of -u and w. simplifier#marks
+  // flags the literals on the component stack.
+  for (root = 0; root < num_lits && !simp->unsat; ++root) {
+    size_t depth = 0;
+    if (order[root] != 0 || simp->num_occs[lit_neg(root)] == 0)
+      continue;
+    order[root] = low[root] = ++counter;
+    component[component_count++] = root;
+    simp->marks[root] = true;
+    frames[depth].lit = root;
+    frames[depth++].edge = 0;
+
+    while (depth > 0) {
+      struct tarjan_frame* frame = &frames[depth - 1];
+      uint32_t const lit = frame->lit;
+      struct occurrence_list const* list = &simp->occs[lit_neg(lit)];
+
+      if (frame->edge < list->count) {
+        struct simplifier_clause const* clause = &simp->clauses[list->clauses[frame->edge++]];
+        uint32_t const* lits = simp->lits + clause->offset;
+        uint32_t next;
+        if (clause->removed || clause->size != 2)
+          continue;
+        next = (lits[0] == lit_neg(lit) ? lits[1] : lits[0]);
+        if (order[next] == 0) {
+          order[next] = low[next] = ++counter;
+          component[component_count++] = next;
+          simp->marks[next] = true;
+          frames[depth].lit = next;
+          frames[depth++].edge = 0;
+        }
+        else if (simp->marks[next] && order[next] < low[lit]) {
+          low[lit] = order[next];
+        }
+        continue;
+      }
+
+      if (--depth > 0 && low[lit] < low[frames[depth - 1].lit])
+        low[frames[depth - 1].lit] = low[lit];
+      if (low[lit] != order[lit])
+        continue;
+
+      // The literals on the stack down to this one form a component,
+      // they are all equivalent. The literal of the lowest variable
+      // represents them. The negated literals form the mirrored
+      // component, which gets the negated representative.
+      count = component_count;
+      do {
+        simp->marks[component[--component_count]] = false;
+      } while (component[component_count] != lit);
+      if (repr[lit] != no_lit)
+        continue;
+      {
+        uint32_t rep = lit;
+        for (index = component_count; index < count; ++index) {
+          if (lit_var(component[index]) < lit_var(rep))
+            rep = component[index];
+        }
+        for (index = component_count; index < count; ++index) {
+          repr[component[index]] = rep;
+        }
+        for (index = component_count; index < count; ++index) {
+          if (repr[lit_neg(component[index])] == rep)
+            simp->unsat = true;
+          repr[lit_neg(component[index])] = lit_neg(rep);
+        }
+      }
     }
-    clause->capacity = new_capacity;
-    clause->vars = new_vars;
-    clause->eliminate = new_eliminate;
   }
+  for (index = 0; index < num_lits; ++index) {
+    simp->marks[index] = false;
+  }
+  if (simp->unsat)
+    goto cleanup;
 
-  clause->vars[clause->count] = var;
-  clause->eliminate[clause->count] = 0;
-  clause->count++;
-  return 0;
+  // Remove the substituted variables and save their equivalence for the
+  // reconstruction of the model.
+  for (index = 0; index < simp->num_vars; ++index) {
+    uint32_t const lit = (uint32_t) index * 2;
+    uint32_t pair[2];
+    if (repr[lit] == no_lit || repr[lit] == lit)
+      continue;
+    pair[0] = lit;
+    pair[1] = lit_neg(repr[lit]);
+    if (!simplifier_push(simp, pair, 2, pair[0]))
+      goto cleanup;
+    pair[0] = lit_neg(lit);
+    pair[1] = repr[lit];
+    if (!simplifier_push(simp, pair, 2, pair[0]))
+      goto cleanup;
+    simp->eliminated[index] = true;
+    simp->num_substituted++;
+  }
+
+  // Replace the clauses that contain a substituted variable. The binary
+  // clauses within a component become tautologies and are dropped.
+  count = simp->count;
+  for (index = 0; index < count && !simp->unsat; ++index) {
+    struct simplifier_clause const* clause = &simp->clauses[index];
+    uint32_t const* lits = simp->lits + clause->offset;
+    size_t i, size = 0;
+    bool tautology = false;
+    if (clause->removed)
+      continue;
+    for (i = 0; i < clause->size; ++i) {
+      if (simp->eliminated[lit_var(lits[i])])
+        break;
+    }
+    if (i == clause->size)
+      continue;
+    for (i = 0; i < clause->size; ++i) {
+      uint32_t const lit = (repr[lits[i]] == no_lit ? lits[i] : repr[lits[i]]);
+      if (simp->marks[lit_neg(lit)])
+        tautology = true;
+      else if (!simp->marks[lit]) {
+        simp->marks[lit] = true;
+        simp->resolvent[size++] = lit;
+      }
+    }
+    for (i = 0; i < size; ++i) {
+      simp->marks[simp->resolvent[i]] = false;
+    }
+    simplifier_remove_clause(simp, (uint32_t) index);
+    if (!tautology && !simplifier_add_clause(simp, simp->resolvent, size))
+      goto cleanup;
+  }
+  simplifier_propagate(simp);
+
+cleanup:
+  free(order);
+  free(low);
+  free(repr);
+  free(component);
+  free(frames);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_shrink_to_fit(struct clause* clause)
+static void simplifier_eliminate(struct simplifier* simp, size_t var)
 {
-  assert(clause->count <= clause->capacity);
-  if (clause->count < clause->capacity) {
-    long long* new_vars = realloc(clause->vars, sizeof(*new_vars) * clause->count);
-    int* new_eliminate = realloc(clause->eliminate, sizeof(*new_eliminate) * clause->count);
-    if (new_vars == NULL || new_eliminate == NULL) {
-      // Memory error. We free the clause so no invalid frees can happen
-      // if a realloc() call succeeded for one of the memory blocks and
-      // moved it to another location.
-      free(new_vars);
-      free(new_eliminate);
-      clause_free(clause);
-      return false;
+  uint32_t const pos = (uint32_t) var * 2;
+  uint32_t const neg = lit_neg(pos);
+  size_t const limit = simp->num_occs[pos] + simp->num_occs[neg];
+  struct occurrence_list* pos_list = &simp->occs[pos];
+  struct occurrence_list* neg_list = &simp->occs[neg];
+  size_t i, j, size, resolvents = 0;
+
+  if (limit == 0 || (simp->num_occs[pos] > elim_occ_limit && simp->num_occs[neg] > elim_occ_limit))
+    return;
+
+  // Drop the removed clauses from the occurrence lists.
+  for (i = 0; i < 2; ++i) {
+    struct occurrence_list* list = (i == 0 ? pos_list : neg_list);
+    size_t k;
+    for (j = 0, k = 0; j < list->count; ++j) {
+      if (!simp->clauses[list->clauses[j]].removed)
+        list->clauses[k++] = list->clauses[j];
     }
-    clause->capacity = clause->count;
-    clause->vars = new_vars;
-    clause->eliminate = new_eliminate;
+    list->count = k;
   }
-  return true;
+
+  // The variable is only eliminated if the resolvents that are not
+  // tautologies are short and not more than the clauses they replace.
+  for (i = 0; i < pos_list->count; ++i) {
+    for (j = 0; j < neg_list->count; ++j) {
+      size = simplifier_resolve(simp, pos_list->clauses[i], neg_list->clauses[j], var);
+      if (size == no_resolvent)
+        continue;
+      if (size > elim_resolvent_limit || ++resolvents > limit)
+        return;
+    }
+  }
+
+  // Save the clauses for the reconstruction of the model, with the
+  // literal of the variable as the witness.
+  for (i = 0; i < 2; ++i) {
+    struct occurrence_list* list = (i == 0 ? pos_list : neg_list);
+    for (j = 0; j < list->count; ++j) {
+      struct simplifier_clause const* clause = &simp->clauses[list->clauses[j]];
+      if (!simplifier_push(simp, simp->lits + clause->offset, clause->size, i == 0 ? pos : neg))
+        return;
+    }
+  }
+
+  simp->eliminated[var] = true;
+  simp->num_eliminated++;
+  for (i = 0; i < pos_list->count && !simp->unsat; ++i) {
+    for (j = 0; j < neg_list->count && !simp->unsat; ++j) {
+      size = simplifier_resolve(simp, pos_list->clauses[i], neg_list->clauses[j], var);
+      if (size != no_resolvent && !simplifier_add_clause(simp, simp->resolvent, size))
+        return;
+    }
+  }
+  for (i = 0; i < 2; ++i) {
+    struct occurrence_list* list = (i == 0 ? pos_list : neg_list);
+    for (j = 0; j < list->count; ++j) {
+      simplifier_remove_clause(simp, list->clauses[j]);
+    }
+    free(list->clauses);
+    list->clauses = NULL;
+    list->count = 0;
+    list->capacity = 0;
+  }
+  simplifier_propagate(simp);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_is_empty(struct clause* clause)
+static void simplifier_strengthen(struct simplifier* simp, uint32_t index, uint32_t lit)
 {
-  size_t index;
-  for (index = 0; index < clause->count; ++index) {
-    if (clause->eliminate[index] == 0)
-      return false;
+  struct simplifier_clause* clause = &simp->clauses[index];
+  uint32_t* lits = simp->lits + clause->offset;
+  uint32_t i;
+
+  for (i = 0; lits[i] != lit; ++i) {}
+  lits[i] = lits[--clause->size];
+  clause->signature = simplifier_signature(lits, clause->size);
+  simplifier_drop_occ(simp, lit);
+  simplifier_touch(simp, lit_var(lit));
+  if (clause->size == 1) {
+    simplifier_assign(simp, lits[0]);
+    simplifier_remove_clause(simp, index);
+    return;
   }
-  return true;
+  for (i = 0; i < clause->size; ++i) {
+    simplifier_touch(simp, lit_var(lits[i]));
+  }
+  simplifier_queue(simp, index);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void clause_set_init(struct clause_set* set)
+static void simplifier_unlink(struct simplifier* simp, uint32_t index, uint32_t lit)
 {
-  set->num_vars = 0;
-  set->count = 0;
-  set->capacity = 0;
-  set->array = NULL;
-  set->eliminate = NULL;
+  struct occurrence_list* list = &simp->occs[lit];
+  size_t i;
+  for (i = 0; list->clauses[i] != index; ++i) {}
+  list->clauses[i] = list->clauses[--list->count];
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void clause_set_free(struct clause_set* set)
+static uint64_t simplifier_signature(uint32_t const* lits, size_t size)
 {
-  size_t index;
-  for (index = 0; index < set->count; ++index) {
-    clause_free(&set->array[index]);
+  uint64_t signature = 0;
+  size_t i;
+  for (i = 0; i < size; ++i) {
+    signature |= (uint64_t) 1 << (lit_var(lits[i]) & 63);
   }
-  free(set->array);
-  free(set->eliminate);
-  clause_set_init(set);
+  return signature;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_set_add(struct clause_set* set, size_t* out_index)
+static bool simplifier_queue(struct simplifier* simp, uint32_t index)
 {
-  if (set->count + 1 > set->capacity) {
-    size_t new_capacity = set->capacity + clause_set_chunksize;
-    struct clause* new_array = realloc(set->array, sizeof(*new_array) * new_capacity);
-    int* new_eliminate = realloc(set->eliminate, sizeof(*new_eliminate) * new_capacity);
-    if (new_array == NULL || new_eliminate == NULL) {
-      free(new_array);
-      free(new_eliminate);
-      clause_set_free(set);
+  if (!simp->options->subsume || simp->clauses[index].queued)
+    return true;
+  if (simp->queue_count + 1 > simp->queue_capacity) {
+    size_t new_capacity = (simp->queue_capacity == 0 ? 1024 : simp->queue_capacity * 2);
+    uint32_t* new_queue = realloc(simp->queue, sizeof(*new_queue) * new_capacity);
+    if (new_queue == NULL) {
+      simp->oom = true;
       return false;
     }
-    set->capacity = new_capacity;
-    set->array = new_array;
-    set->eliminate = new_eliminate;
+    simp->queue_capacity = new_capacity;
+    simp->queue = new_queue;
   }
-  clause_init(&set->array[set->count]);
-  *out_index = set->count;
-  set->count++;
+  simp->clauses[index].queued = true;
+  simp->queue[simp->queue_count++] = index;
   return true;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_set_parse(struct clause_set* set, FILE* fp)
+static void simplifier_subsume_all(struct simplifier* simp)
 {
-  int res;
-  long long value, num_vars, num_clauses;
-  static long long size_max = (size_t) -1;
-
-  // Skip all comment lines.
-  while (skip_char(fp, 'c')) {
-    int c;
-    while ((c = getc(fp)) != '\n')
-      ;
+  // The queue is used as a stack, the clauses that are strengthened
+  // while a clause is checked are checked next.
+  while (simp->queue_count > 0 && !simp->unsat && !simp->oom) {
+    uint32_t const index = simp->queue[--simp->queue_count];
+    simp->clauses[index].queued = false;
+    if (!simp->clauses[index].removed)
+      simplifier_subsume(simp, index);
+    simplifier_propagate(simp);
   }
+}
 
-  // Read the pre conditions.
-  if (!skip_char(fp, 'p')) {
-    dpll_puterr("clause_set_parse(): expected 'p' instruction");
-    return false;
-  }
-  skip_whitespace(fp);
-  if (!match_token(fp, "cnf")) {
-    dpll_puterr("clause_set_parse(): expected 'cnf' token");
-    return false;
-  }
-  skip_whitespace(fp);
-  if (!read_long_long(fp, &num_vars)) {
-    dpll_puterr("clause_set_parse(): expected num vars");
-    return false;
-  }
-  skip_whitespace(fp);
-  if (!read_long_long(fp, &num_clauses))
-    num_clauses = 0;
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_subsume(struct simplifier* simp, uint32_t index)
+{
+  struct simplifier_clause const* clause = &simp->clauses[index];
+  uint32_t const* lits = simp->lits + clause->offset;
+  uint64_t const signature = clause->signature;
+  uint32_t const size = clause->size;
+  uint32_t best = lits[0];
+  uint32_t i, polarity;
 
-  if (num_vars < 0 || num_vars > size_max) {
-    errno = EINVAL;
-    dpll_puterr("clause_set_parse(): literal count too big or not positive");
-    return false;
+  for (i = 1; i < size; ++i) {
+    uint32_t const lit = lits[i];
+    if (simp->num_occs[lit] + simp->num_occs[lit_neg(lit)] <
+        simp->num_occs[best] + simp->num_occs[lit_neg(best)])
+      best = lit;
   }
-  set->num_vars = (size_t) num_vars;
-
-  skip_whitespace(fp);
-  if (!skip_char(fp, '\n')) {
-    // expected newline after number of literals.
-    errno = EINVAL;
-    dpll_puterr("clause_set_parse(): expected newline after 'p' instruction, got %c", getc(fp));
-    return false;
+  for (i = 0; i < size; ++i) {
+    simp->marks[lits[i]] = true;
   }
 
-  // Read a clause from each line. Since empty clauses don't make
-  // much sense in a CNF (as they evaluate to false), we simply
-  // skip empty lines.
-  while (!feof(fp)) {
-    size_t index = 0;
-    struct clause* clause = NULL;
-
-    skip_whitespace(fp);
-    if (skip_char(fp, '\n') || skip_char(fp, EOF))
-      continue;
-
-    if (!clause_set_add(set, &index)) {
-      errno = ENOMEM;
-      dpll_puterr("clause_set_parse(): could not add new clause");
-      return false;
-    }
-    clause = &set->array[index];
+  // A candidate must contain every variable of the clause, thus both
+  // polarities of one of them cover all candidates. The lists are
+  // visited backwards, so the candidates that are unlinked from them
+  // are not skipped.
+  for (polarity = 0; polarity < 2; ++polarity) {
+    struct occurrence_list* list = &simp->occs[polarity == 0 ? best : lit_neg(best)];
+    size_t pos = list->count;
+    while (pos > 0 && !simp->unsat) {
+      uint32_t const other = list->clauses[--pos];
+      struct simplifier_clause const* candidate = &simp->clauses[other];
+      uint32_t const* other_lits = simp->lits + candidate->offset;
+      uint32_t matches = 0, j;
+      uint32_t flipped = no_lit;
 
-    while (true) {
-      skip_whitespace(fp);
-      if (skip_char(fp, '0')) {
-        skip_whitespace(fp);
-        if (!skip_char(fp, '\n')) {
-          dpll_puterr("clause_set_parse(): clause #"PRsize_t": expected newline after clause terminator", index);
-          return false;
+      if (other == index || candidate->removed || candidate->size < size ||
+          (signature & ~candidate->signature) != 0)
+        continue;
+      for (j = 0; j < candidate->size; ++j) {
+        uint32_t const lit = other_lits[j];
+        if (simp->marks[lit])
+          matches++;
+        else if (simp->marks[lit_neg(lit)] && flipped == no_lit) {
+          flipped = lit;
+          matches++;
         }
-        break;
-      }
-
-      if (!read_long_long(fp, &value)) {
-        errno = EINVAL;
-        dpll_puterr("clause_set_parse(): clause #"PRsize_t": expected literal ", index);
-        return false;
-      }
-
-      if (value < -num_vars || value > num_vars || value == 0) {
-        errno = EINVAL;
-        dpll_puterr(
-          "clause_set_parse(): clause #"PRsize_t": literal "
-          "'%llu' not in range", index, value);
-        return false;
       }
-
-      res = clause_add(clause, value);
-      if (res == -1) {
-        errno = ENOMEM;
-        dpll_puterr("clause_set_parse(): could not add literal to clause");
-        return false;
+      if (matches < size)
+        continue;
+      if (flipped == no_lit) {
+        simplifier_remove_clause(simp, other);
+        simp->num_subsumed++;
       }
-      else if (res == 1) {
-        dpll_puterr(
-          "clause_set_parse(): warning: clause #"PRsize_t": "
-          "contains duplicate literal '%llu'", index, value);
+      else {
+        simplifier_unlink(simp, other, flipped);
+        simplifier_strengthen(simp, other, flipped);
+        simp->num_strengthened++;
       }
-      else assert(res == 0);
-      clause_shrink_to_fit(clause);
     }
   }
 
-  return true;
+  for (i = 0; i < size; ++i) {
+    simp->marks[lits[i]] = false;
+  }
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void clause_set_format(struct clause_set* set, FILE* fp)
+static size_t simplifier_resolve(
+  struct simplifier* simp, uint32_t a, uint32_t b, size_t var)
 {
-  size_t index;
-  fprintf(fp, PRsize_t"\n", set->num_vars);
-  for (index = 0; index < set->count; ++index) {
-    size_t j;
-    struct clause* clause = &set->array[index];
-    for (j = 0; j < clause->count; ++j) {
-      printf("%lld ", clause->vars[j]);
+  struct simplifier_clause const* first = &simp->clauses[a];
+  struct simplifier_clause const* second = &simp->clauses[b];
+  uint32_t const* lits = simp->lits + first->offset;
+  size_t i, size = 0;
+
+  for (i = 0; i < first->size; ++i) {
+    if (lit_var(lits[i]) != var) {
+      simp->marks[lits[i]] = true;
+      simp->resolvent[size++] = lits[i];
     }
-    printf("\n");
   }
-}
+  lits = simp->lits + second->offset;
+  for (i = 0; i < second->size && size != no_resolvent; ++i) {
+    if (lit_var(lits[i]) == var || simp->marks[lits[i]])
+      continue;
+    if (simp->marks[lit_neg(lits[i])])
+      size = no_resolvent;
+    else
+      simp->resolvent[size++] = lits[i];
+  }
 
-//-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-bool clause_set_is_empty(struct clause_set* set)
-{
-  size_t index;
-  for (index = 0; index < set->count; ++index) {
-    if (set->eliminate[index] == 0)
-      return false;
+  lits = simp->lits + first->offset;
+  for (i = 0; i < first->size; ++i) {
+    simp->marks[lits[i]] = false;
   }
-  return true;
+  return size;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_set_eliminate(struct clause_set* set, long long var, bool reset)
+static bool simplifier_push(
+  struct simplifier* simp, uint32_t const* lits, size_t size, uint32_t witness)
 {
-  int add = (reset ? -1 : 1);
-  size_t index;
-  for (index = 0; index < set->count; ++index) {
-    size_t j;
-    struct clause* clause = &set->array[index];
-    for (j = 0; j < clause->count; ++j) {
-      if (clause->vars[j] == var) {
-        set->eliminate[index] += add;
-      }
-      else if (clause->vars[j] == -var) {
-        clause->eliminate[j] += add;
-        if (!reset && clause_is_empty(clause))
-          return false;
-      }
+  size_t i;
+
+  if (simp->stack_count + size + 1 > simp->stack_capacity) {
+    size_t new_capacity = (simp->stack_capacity == 0 ? 1024 : simp->stack_capacity * 2);
+    uint32_t* new_stack;
+    while (new_capacity < simp->stack_count + size + 1)
+      new_capacity *= 2;
+    new_stack = realloc(simp->stack, sizeof(*new_stack) * new_capacity);
+    if (new_stack == NULL) {
+      simp->oom = true;
+      return false;
     }
+    simp->stack_capacity = new_capacity;
+    simp->stack = new_stack;
+  }
+  simp->stack[simp->stack_count++] = witness;
+  for (i = 0; i < size; ++i) {
+    if (lits[i] != witness)
+      simp->stack[simp->stack_count++] = lits[i];
   }
+  simp->stack[simp->stack_count++] = (uint32_t) size;
   return true;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool clause_set_solve(
-  struct clause_set* set, bool** out_values,
-  clause_set_solve_callback callback, void* userdata)
+static bool simplifier_extract(struct simplifier const* simp, struct clause_set* set)
 {
-  bool sat = false;
-  bool search = true;
-  bool* pre_cond = malloc(sizeof(bool) * set->num_vars);
-  *out_values = malloc(sizeof(bool) * set->num_vars);
-  if (!*out_values || !pre_cond) {
+  size_t index, count = simp->units_count;
+  set->num_vars = simp->num_vars;
+  for (index = 0; index < simp->count; ++index) {
+    if (!simp->clauses[index].removed)
+      count++;
+  }
+  if (!clause_set_reserve(set, count + 1, simp->num_lits + simp->units_count))
     return false;
+
+  // An unsatisfiable clause_set is reduced to the empty clause.
+  if (simp->unsat) {
+    set->offsets[++set->count] = 0;
+    return true;
   }
-  _clause_set_solve(set, *out_values, pre_cond, 0, callback, userdata, &sat, &search);
-  if (!sat) {
-    free(*out_values);
-    *out_values = NULL;
+
+  // The assigned literals are passed on as unit clauses.
+  for (index = 0; index < simp->units_count; ++index) {
+    set->lits[set->num_lits++] = simp->units[index];
+    set->offsets[++set->count] = set->num_lits;
   }
-  return sat;
+  for (index = 0; index < simp->count; ++index) {
+    struct simplifier_clause const* clause = &simp->clauses[index];
+    if (clause->removed)
+      continue;
+    memcpy(set->lits + set->num_lits, simp->lits + clause->offset, sizeof(uint32_t) * clause->size);
+    set->num_lits += clause->size;
+    set->offsets[++set->count] = set->num_lits;
+  }
+  return true;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool _clause_set_solve(
-  struct clause_set* set, bool* out_values, bool* pre_cond, long long last_var,
-  clause_set_solve_callback callback, void* userdata, bool* sat, bool* search)
+static void simplifier_extend(struct simplifier const* simp, bool* values)
 {
-  long long curr_var = last_var + 1;
-  assert(last_var <= (long long) set->num_vars);
-
-  if (!*search)
-    return false;
+  size_t index = simp->stack_count;
 
-  if (last_var == set->num_vars) {
-    if (clause_set_is_empty(set)) {
-      *sat = true;
-      if (callback)
-        *search = callback(set->num_vars, out_values, userdata);
-      else
-        *search = false;
-      return true;
+  // A saved clause that is not satisfied is satisfied by its witness.
+  // Both polarities of an eliminated variable are saved, but at most
+  // the clauses of one of them can be unsatisfied, else the model
+  // would not satisfy their resolvent.
+  while (index > 0) {
+    size_t const size = simp->stack[--index];
+    uint32_t const* lits;
+    size_t i;
+    index -= size;
+    lits = simp->stack + index;
+    for (i = 0; i < size; ++i) {
+      if (values[lit_var(lits[i])] == lit_positive(lits[i]))
+        break;
     }
-    return false;
-  }
-
-  // xxx: eventually find a better literal than just the next. (ie. from
-  // a clause that only contains that literal). Use pre_cond for that!
-
-  out_values[curr_var - 1] = true;
-  if (clause_set_eliminate(set, curr_var, false) && _clause_set_solve(set, out_values, pre_cond, curr_var, callback, userdata, sat, search)) {
-    if (!*search)
-      return true;
-  }
-  clause_set_eliminate(set, curr_var, true);  // revert
-
-  out_values[curr_var - 1] = false;
-  if (clause_set_eliminate(set, -curr_var, false) && _clause_set_solve(set, out_values, pre_cond, curr_var, callback, userdata, sat, search)) {
-    if (!*search)
-      return true;
+    if (i == size)
+      values[lit_var(lits[0])] = lit_positive(lits[0]);
   }
-  clause_set_eliminate(set, -curr_var, true);  // revert
-  return false;;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-static bool read_long_long(FILE* fp, long long* result)
+static size_t simplifier_cost(struct simplifier const* simp, size_t var)
 {
-  int c;
-  size_t const max_digits = (size_t) floor(log10((double) LLONG_MAX)) + 1;
-  size_t digits = 0;
-  bool negative = false;
-
-  *result = 0;
-  c = getc(fp);
-  if (c == '-') {
-    negative = true;
-    c = getc(fp);
-  }
+  return simp->num_occs[var * 2] * simp->num_occs[var * 2 + 1];
+}
 
-  while (c >= '0' && c <= '9') {
-    if (digits == max_digits) {
-      errno = ERANGE;
-      return false;
-    }
-    digits++;
-    *result = *result * 10 + c - '0';
-    c = getc(fp);
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void simplifier_touch(struct simplifier* simp, size_t var)
+{
+  if (!simp->options->eliminate || simp->eliminated[var] || simp->values[var * 2] != value_unset)
+    return;
+  if (simp->heap_index[var] == not_in_heap) {
+    simp->heap[simp->heap_count] = var;
+    simp->heap_index[var] = simp->heap_count;
+    simplifier_heap_up(simp, simp->heap_count++);
   }
-
-  ungetc(c, fp);
-  if (negative)
-    *result *= -1;
-  if (digits == 0) {
-    errno = EILSEQ;
-    return false;
+  else {
+    simplifier_heap_up(simp, simp->heap_index[var]);
+    simplifier_heap_down(simp, simp->heap_index[var]);
   }
-  return true;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-void skip_whitespace(FILE* fp)
+static void simplifier_heap_up(struct simplifier* simp, size_t pos)
 {
-  int c;
-  while (isspace(c = getc(fp)) && c != '\n')
-    ;
-  ungetc(c, fp);
+  size_t const var = simp->heap[pos];
+  size_t const cost = simplifier_cost(simp, var);
+  while (pos > 0) {
+    size_t const parent = (pos - 1) / 2;
+    if (simplifier_cost(simp, simp->heap[parent]) <= cost)
+      break;
+    simp->heap[pos] = simp->heap[parent];
+    simp->heap_index[simp->heap[pos]] = pos;
+    pos = parent;
+  }
+  simp->heap[pos] = var;
+  simp->heap_index[var] = pos;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool skip_char(FILE* fp, int c)
+static void simplifier_heap_down(struct simplifier* simp, size_t pos)
 {
-  int h = getc(fp);
-  if (h == c)
-    return true;
-  ungetc(h, fp);
-  return false;
+  size_t const var = simp->heap[pos];
+  size_t const cost = simplifier_cost(simp, var);
+  while (true) {
+    size_t child = pos * 2 + 1;
+    if (child >= simp->heap_count)
+      break;
+    if (child + 1 < simp->heap_count &&
+        simplifier_cost(simp, simp->heap[child + 1]) < simplifier_cost(simp, simp->heap[child]))
+      child++;
+    if (simplifier_cost(simp, simp->heap[child]) >= cost)
+      break;
+    simp->heap[pos] = simp->heap[child];
+    simp->heap_index[simp->heap[pos]] = pos;
+    pos = child;
+  }
+  simp->heap[pos] = var;
+  simp->heap_index[var] = pos;
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-bool match_token(FILE* fp, const char* str)
+static size_t simplifier_heap_pop(struct simplifier* simp)
 {
-  off_t pos = ftello(fp);
-  int c;
-  while (*str && (c = getc(fp)) == *str) {
-    str++;
+  size_t const var = simp->heap[0];
+  assert(simp->heap_count > 0);
+  simp->heap_index[var] = not_in_heap;
+  if (--simp->heap_count > 0) {
+    simp->heap[0] = simp->heap[simp->heap_count];
+    simp->heap_index[simp->heap[0]] = 0;
+    simplifier_heap_down(simp, 0);
   }
-  if (!*str) return true;
-  fseeko(fp, pos, 0);
-  return false;
+  return var;
 }
@@ -7,14 +7,25 @@
 #ifndef DPLL_H_
 #define DPLL_H_
 
+#include <stdint.h>
 #include <stdio.h>
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-// Latest error infromation. Allocated with malloc(). Modify with dpll_puterr().
-extern char dpll_errinfo[BUFSIZ];
+// Storage class of the variables that every thread has a copy of.
+#ifdef _MSC_VER
+  #define DPLL_THREAD_LOCAL __declspec(thread)
+#else
+  #define DPLL_THREAD_LOCAL __thread
+#endif
 
-// Update the #dpll_errinfo, freeing the previous value.
+// Latest error information of the calling thread. Modify with
+// dpll_puterr(). Each thread has its own message, thus the functions
+// of this library can run on several threads at once and every thread
+// reads the errors of its own calls.
+extern DPLL_THREAD_LOCAL char dpll_errinfo[BUFSIZ];
+
+// Update the #dpll_errinfo of the calling thread.
 void dpll_puterr(const char* fmt, ...);
 
 //-----------------------------------------------------------------------------
@@ -27,7 +38,22 @@ enum bool
 typedef enum bool bool;
 
 //-----------------------------------------------------------------------------
-// This struct represents a disjunctive clause of propositional logic.
+// Inside a clause_set and the solver, the literal of the variable with
+// the zero based index v is encoded as the unsigned 32-bit code 2 * v,
+// and its negation as 2 * v + 1. A literal and its negation differ only
+// in the lowest bit, so that arrays can be indexed by literal directly.
+// The DIMACS literal v + 1 or -(v + 1) is only used at the edges.
+//-----------------------------------------------------------------------------
+
+// Return the code of a non-zero DIMACS literal.
+uint32_t lit_from_dimacs(long long dimacs);
+
+// Return the DIMACS literal of a literal code.
+long long lit_to_dimacs(uint32_t lit);
+
+//-----------------------------------------------------------------------------
+// This struct represents a disjunctive clause of propositional logic
+// while it is built. Use clause_set_add() to add it to a clause_set.
 //-----------------------------------------------------------------------------
 struct clause
 {
@@ -39,14 +65,9 @@ struct clause
   // memory can be shrinked with clause_shrink_to_fit().
   size_t capacity;
 
-  // An array of #count literal indices. A negative value indicates that
+  // An array of #count DIMACS literals. A negative value indicates that
   // the literal is negated.
   long long* vars;
-
-  // An array of #count values that indicate wether the respective
-  // literal is eliminate from the clause. A non-zero value indicates
-  // that the literal is eliminated.
-  int* eliminate;
 };
 
 // Initialize an empty clause.
@@ -60,39 +81,46 @@ void clause_free(struct clause* clause);
 // the clause in case of a memory error.
 int clause_add(struct clause* clause, long long const var);
 
-// Shrink the buffers for clause#vars and clause#eliminate to fit the
-// filled count. Return true on success, false on a memory error. Free
-// the clause in case of a memory error.
+// Shrink the buffer for clause#vars to fit the filled count. Return
+// true on success, false on a memory error. Free the clause in case of
+// a memory error.
 bool clause_shrink_to_fit(struct clause* clause);
 
-// Return true if all literals of the clause are eliminated, which
-// is equal to an empty clause. An empty clause evaluates to false.
-bool clause_is_empty(struct clause* clause);
-
 //-----------------------------------------------------------------------------
-// Represents a conjunctive normal form and a set of clauses.
+// Represents a conjunctive normal form and a set of clauses. The
+// literals of all clauses are stored in one contiguous buffer.
 //-----------------------------------------------------------------------------
 struct clause_set
 {
   // The number of literals used in the clauses. Must be updated manually
   // when new literals are introduced. Remember that the index of a literal
   // is offset by one, since we can't use the literal 0 as it can not be
-  // negative.
+  // negative. Must not be larger than INT32_MAX.
   size_t num_vars;
 
   // The number of clauses present in the set.
   size_t count;
 
-  // The capacity of the buffer.
+  // The capacity of #offsets.
   size_t capacity;
 
-  // An array of #count clasues.
-  struct clause* array;
+  // An array of #count + 1 offsets into #lits. The literals of the
+  // clause with index i are lits[offsets[i]] to lits[offsets[i + 1] - 1].
+  size_t* offsets;
 
-  // An array of #count values that indicate that wether the
-  // respective clause is eliminated. A non-zero value indicates
-  // that the clause is eliminated.
-  int* eliminate;
+  // The number of literals in #lits and the capacity of the buffer.
+  size_t num_lits;
+  size_t lits_capacity;
+
+  // The literals of all clauses, encoded with lit_from_dimacs().
+  uint32_t* lits;
+
+  // If the clause_set was loaded with clause_set_load_cache(), the
+  // read-only mapping of the cache file that #offsets and #lits point
+  // into, and its size. The buffers are copied out of the mapping when
+  // clauses are added.
+  void* map;
+  size_t map_size;
 };
 
 // Initialize an empty clause_set.
@@ -101,19 +129,57 @@ void clause_set_init(struct clause_set* set);
 // Free a clause set.
 void clause_set_free(struct clause_set* set);
 
-// Allocate a clause in the clause_set and return the clause index.
-// Return true on succes, false on memory error.
-bool clause_set_add(struct clause_set* set, size_t* out_index);
+// Append a copy of the literals of \p clause to the clause_set as a new
+// clause, converted to literal codes. Return true on succes, false on
+// memory error. Free the clause_set in case of a memory error.
+bool clause_set_add(struct clause_set* set, struct clause const* clause);
+
+// Release the unused capacity of the buffers of the clause_set. Return
+// true on success, false on a memory error. The clause_set is unchanged
+// in case of a memory error.
+bool clause_set_shrink_to_fit(struct clause_set* set);
+
+//-----------------------------------------------------------------------------
+// Appends clauses to a clause_set one literal at a time, without a
+// struct clause in between. The buffers of the clause_set double their
+// capacity when they are full, and duplicate literals and tautologies
+// in long clauses are detected with one stamp per literal. Adding a
+// clause thus takes time linear in its length. Call
+// clause_set_shrink_to_fit() once after the last clause.
+//-----------------------------------------------------------------------------
+struct clause_builder
+{
+  // The clause_set the clauses are appended to.
+  struct clause_set* set;
+
+  // The number of literals of the unfinished clause. They are stored
+  // in set#lits after the literals of the finished clauses.
+  size_t count;
+
+  // An array of #num_stamps stamps, indexed by literal code. A literal
+  // is in the unfinished clause if its stamp equals #stamp, which is
+  // incremented for every clause.
+  uint32_t* stamps;
+  size_t num_stamps;
+  uint32_t stamp;
+};
+
+// Initialize a builder that appends clauses to \p set.
+void clause_builder_init(struct clause_builder* builder, struct clause_set* set);
+
+// Free a builder. The unfinished clause is discarded.
+void clause_builder_free(struct clause_builder* builder);
 
-// Return true if the clause_set is empty.
-bool clause_set_is_empty(struct clause_set* set);
+// Append the specified DIMACS literal to the unfinished clause. Return
+// 1 if the literal is already in the clause, in which case it is not
+// appended again, 2 if its negation is in the clause, -1 on a memory
+// error and 0 otherwise. The clause_set is unchanged in case of a
+// memory error.
+int clause_builder_add(struct clause_builder* builder, long long const var);
 
-// Eliminate all clauses that contain the specified literal and
-// eliminate all literals in all clauses that contain the invert
-// of that literal. If \p reset is true, all changes made will
-// be reverted.
-// Return false if a clause is empty after this call.
-bool clause_set_eliminate(struct clause_set* set, long long var, bool reset);
+// Append the unfinished clause to the clause_set and start a new one.
+// Return true on success, false on a memory error.
+bool clause_builder_end(struct clause_builder* builder);
 
 // Parse a DIMACS CNF file from the specified FILE and fills the
 // clause_set \p set. As an additional, this parser function does
@@ -123,17 +189,227 @@ bool clause_set_eliminate(struct clause_set* set, long long var, bool reset);
 // For more information on the DIMACS CNF format, see:
 //   http://logic.pdmi.ras.ru/~basolver/dimacs.html
 //
+// The input may be compressed with gzip, xz or bzip2 if the support
+// for the format is compiled in (DPLL_HAVE_ZLIB, DPLL_HAVE_LZMA and
+// DPLL_HAVE_BZLIB). The format is detected from the first bytes. A
+// compressed input is decompressed on a thread of its own while the
+// clauses are parsed.
+//
 // Return true on success, false on error. #errno is set if the
 // function returned false.
 bool clause_set_parse(struct clause_set* set, FILE* fp);
 
+// Like clause_set_parse(), but the clauses are parsed by up to \p
+// num_threads threads, each on a chunk of complete lines of the input.
+// The clauses are appended in the order of the input, and the clause
+// numbers in the messages of #dpll_errinfo are the same as with
+// clause_set_parse(). If \p num_threads is 0, one thread per online
+// processor is used. A compressed input is always parsed on one thread,
+// next to the thread that decompresses it, and \p num_threads is
+// ignored.
+bool clause_set_parse_parallel(
+  struct clause_set* set, FILE* fp, size_t num_threads);
+
+// Like clause_set_parse_parallel(), but the input is read from the
+// file at \p path, or from stdin if \p path is NULL or "-".
+bool clause_set_parse_file(
+  struct clause_set* set, const char* path, size_t num_threads);
+
 // Format the clause, parsable by clause_set_parse().
 void clause_set_format(struct clause_set* set, FILE* fp);
 
+// Write the clause_set to the binary cache file at \p path. The cache
+// records the size and the modification time of the DIMACS file \p
+// source it was parsed from, unless \p source is NULL. Return true on
+// success, false on error. #errno is set if the function returned
+// false.
+bool clause_set_write_cache(
+  struct clause_set const* set, const char* path, const char* source);
+
+// Load a cache written by clause_set_write_cache() into the empty
+// clause_set \p set. The file is mapped into memory read-only and the
+// clause_set points into the mapping, thus loading takes about the
+// time of one checksum pass over the literals. Free the clause_set
+// with clause_set_free() as usual.
+//
+// Return false and set #errno if the cache can not be read (the errno
+// of the failed call), is not a cache of this format and byte order or
+// fails its checksum (#EILSEQ), or is stale, ie. \p source is not NULL
+// and its size or modification time differ from the file the cache was
+// written for (#ESTALE).
+bool clause_set_load_cache(
+  struct clause_set* set, const char* path, const char* source);
+
 typedef bool (*clause_set_solve_callback)(
   size_t num_vars, bool* out_values, void* userdata);
 
+// The search algorithm used by clause_set_solve().
+enum clause_set_solve_mode
+{
+  // Chronological backtracking without clause learning.
+  solve_mode_dpll,
+
+  // Conflict driven clause learning with first unique implication
+  // point learning and non-chronological backjumping.
+  solve_mode_cdcl,
+};
+
+// The restart policy of the CDCL search. A restart undoes all
+// decisions but keeps the learned clauses and variable activities.
+enum clause_set_solve_restarts
+{
+  // Never restart.
+  restarts_none,
+
+  // Restart after options#luby_unit times the next element of the
+  // Luby sequence conflicts.
+  restarts_luby,
+
+  // Restart when the average LBD of the recently learned clauses is
+  // high compared to the average of all learned clauses (Glucose).
+  restarts_glucose,
+};
+
+// Statistics of a clause_set_solve() call.
+struct clause_set_solve_stats
+{
+  // The number of conflicts, decisions and restarts.
+  size_t conflicts;
+  size_t decisions;
+  size_t restarts;
+
+  // The number of literals of the clauses learned from conflicts before
+  // minimization, and the number of them removed by minimization.
+  size_t learned_lits;
+  size_t minimized_lits;
+
+  // The number of variables eliminated before the search, the number
+  // of clauses removed because another clause subsumes them, and the
+  // number of literals removed by self-subsuming resolution.
+  size_t eliminated;
+  size_t subsumed;
+  size_t strengthened;
+
+  // The number of variables replaced by an equivalent literal, and the
+  // number of pure literals that were assigned.
+  size_t substituted;
+  size_t pure_lits;
+
+  // The number of literals found false by probing, the number of
+  // literals implied by both literals of a probed variable, and the
+  // number of hyper-binary resolvents added by probing.
+  size_t failed_lits;
+  size_t implied_lits;
+  size_t hyper_binaries;
+
+  // The number of clauses the solver received from the other solvers of
+  // a portfolio, see options#threads. With a portfolio, the statistics
+  // of the search are those of the solver that finished first.
+  size_t imported;
+};
+
+// Options for clause_set_solve().
+struct clause_set_solve_options
+{
+  // The search algorithm. Defaults to #solve_mode_cdcl.
+  enum clause_set_solve_mode mode;
+
+  // The restart policy. Defaults to #restarts_glucose.
+  enum clause_set_solve_restarts restarts;
+
+  // The number of conflicts per unit of the Luby sequence. Defaults
+  // to 100.
+  size_t luby_unit;
+
+  // The number of recently learned clauses whose LBDs are averaged,
+  // and the factor applied to that average before it is compared to
+  // the overall average. Default to 50 and 0.8.
+  size_t glucose_window;
+  double glucose_factor;
+
+  // The number of conflicts until the learned clauses are reduced for
+  // the first time, and the number of conflicts by which the interval
+  // grows after each reduction. Default to 2000 and 300.
+  size_t reduce_interval;
+  size_t reduce_increment;
+
+  // Learned clauses with an LBD up to 2 are always kept. Learned
+  // clauses with an LBD up to this value are kept as long as they take
+  // part in conflicts between two reductions. Defaults to 6.
+  size_t tier2_lbd;
+
+  // Decide variables with the value they had when they were last
+  // unassigned. Defaults to true.
+  bool phase_saving;
+
+  // The number of conflicts after which the saved phases are reset to
+  // the values of the longest conflict free trail seen since the last
+  // reset. 0 disables rephasing. Defaults to 1000.
+  size_t rephase_interval;
+
+  // Remove the literals from a learned clause that are implied by its
+  // other literals through the reasons of their assignments (recursive
+  // minimization). Defaults to true.
+  bool minimize;
+
+  // Remove the literals from a short learned clause that are implied by
+  // its asserting literal through a binary clause. Defaults to true.
+  bool minimize_binary;
+
+  // If not NULL, the statistics of the search are stored here when
+  // clause_set_solve() returns. Defaults to NULL.
+  struct clause_set_solve_stats* stats;
+
+  // Eliminate variables before the search by replacing the clauses that
+  // contain a variable with their resolvents, if that does not add
+  // clauses. The solutions are extended to the eliminated variables,
+  // but a callback sees only one of the solutions that differ in them.
+  // Defaults to false.
+  bool eliminate;
+
+  // Remove the clauses that contain all literals of another clause
+  // before the search, and remove the literal from a clause that
+  // contains all literals of another clause but one, which it contains
+  // negated. Also applied to the resolvents of eliminated variables.
+  // Defaults to true.
+  bool subsume;
+
+  // Replace the literals that are equivalent through a cycle of binary
+  // clauses by one of them before the search. The solutions are
+  // extended to the replaced variables. Defaults to true.
+  bool substitute;
+
+  // Assign the literals whose negation occurs in no clause before the
+  // search. Only used without a callback, since the solutions in which
+  // a pure literal is false are skipped. Defaults to true.
+  bool pure;
+
+  // Before the search, assign each literal of the variables with binary
+  // clauses in turn and propagate it. A literal that leads to a conflict
+  // is false, and a literal implied by both literals of a variable is
+  // true. Probing stops after this many literals have been assigned by
+  // the propagation, 0 disables it. Defaults to 500000.
+  size_t probe_budget;
+
+  // The number of solvers that search in parallel, each on a thread of
+  // its own and with different restart policies, decision orders and
+  // phases. Only the first solver probes, the others start with its
+  // results. They share their learned units, binary clauses and clauses
+  // with a low LBD, which a solver adds whenever it is back on level 0:
+  // after a restart or a learned unit. The first solver keeps the
+  // #restarts policy and, with #restarts_none, adds shared clauses only
+  // after learned units; the others always restart. The first solver
+  // that finds a solution or proves that there is none stops the
+  // others. Only used in #solve_mode_cdcl without a callback. 0 uses one
+  // solver per online processor. Defaults to 1.
+  size_t threads;
+};
+
+// Initialize the options with their default values.
+void clause_set_solve_options_init(struct clause_set_solve_options* options);
+
 // Solve the specified clause_set to find the first possible solution.
+// If \p options is NULL, the default options are used.
 // Return true if the clause_set is satisfiable, false if not. If true
 // is returned, \p out_values is set and must be freed using free().
 // Set #errno if an error occurs.
@@ -141,8 +417,17 @@ typedef bool (*clause_set_solve_callback)(
 // If \p callback is specified, the function attempts to find all
 // possible solutions until the callback returns false. The returned
 // \p out_values will be the last solution found instead of the first.
+//
+// The search uses unit propagation with two watched literals per
+// clause and decides on the variable with the highest VSIDS activity,
+// which is bumped whenever the variable takes part in a conflict. The
+// clauses are copied into an arena owned by the solver.
+//
+// All state of the search is owned by the call, \p set is only read.
+// Thus the same or different clause_sets can be solved on several
+// threads at once, as long as each thread passes its own options#stats.
 bool clause_set_solve(
-  struct clause_set* set, bool** out_values,
-  clause_set_solve_callback callback, void* userdata);
+  struct clause_set* set, struct clause_set_solve_options const* options,
+  bool** out_values, clause_set_solve_callback callback, void* userdata);
 
 #endif // DPLL_H_
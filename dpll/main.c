@@ -6,7 +6,9 @@
 
 #include "dpll.h"
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>  // getopt
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -26,29 +28,153 @@ bool sat_callback(size_t num_vars, bool* values, void* userdata)
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
-int main()
+static void usage(const char* prog)
+{
+  fprintf(stderr,
+    "usage: %s [-m dpll|cdcl] [-r none|luby|glucose] [-j count]\n"
+    "          [-p count] [-c cache] [-w cache] [-e] [-s] [input.cnf]\n"
+    "\n"
+    "The input is read from stdin if no file or '-' is specified. It may\n"
+    "be compressed with gzip, xz or bzip2.\n"
+    "\n"
+    "  -j count  parse with count threads, 0 for one per processor. A\n"
+    "            compressed input is always parsed on one thread\n"
+    "  -p count  search with count parallel solvers, 0 for one per\n"
+    "            processor, and print only the first solution\n"
+    "  -c cache  load the clauses from a binary cache instead of parsing\n"
+    "            the input, if the cache is up to date with the input file\n"
+    "  -w cache  write the parsed clauses to a binary cache\n"
+    "  -e        eliminate variables before the search, only one of the\n"
+    "            solutions that differ in eliminated variables is printed\n"
+    "  -s        print statistics of the search to stderr\n", prog);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static void print_stats(struct clause_set_solve_stats const* stats)
+{
+  fprintf(stderr, "conflicts: %lu\n", (unsigned long) stats->conflicts);
+  fprintf(stderr, "decisions: %lu\n", (unsigned long) stats->decisions);
+  fprintf(stderr, "restarts: %lu\n", (unsigned long) stats->restarts);
+  fprintf(stderr, "eliminated variables: %lu\n", (unsigned long) stats->eliminated);
+  fprintf(stderr, "substituted variables: %lu\n", (unsigned long) stats->substituted);
+  fprintf(stderr, "pure literals: %lu\n", (unsigned long) stats->pure_lits);
+  fprintf(stderr, "failed literals: %lu\n", (unsigned long) stats->failed_lits);
+  fprintf(stderr, "implied literals: %lu\n", (unsigned long) stats->implied_lits);
+  fprintf(stderr, "hyper-binary resolvents: %lu\n", (unsigned long) stats->hyper_binaries);
+  fprintf(stderr, "imported clauses: %lu\n", (unsigned long) stats->imported);
+  fprintf(stderr, "subsumed clauses: %lu\n", (unsigned long) stats->subsumed);
+  fprintf(stderr, "strengthened clauses: %lu\n", (unsigned long) stats->strengthened);
+  fprintf(stderr, "minimized literals: %lu of %lu (%.1f%%)\n",
+    (unsigned long) stats->minimized_lits, (unsigned long) stats->learned_lits,
+    stats->learned_lits ? 100.0 * stats->minimized_lits / stats->learned_lits : 0.0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+static double wall_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int main(int argc, char** argv)
 {
   bool* values = NULL;
   struct clause_set set;
-  clock_t tstart = 0, tdelta = 0;
+  struct clause_set_solve_options options;
+  struct clause_set_solve_stats stats;
+  double parse_start, solve_start, solve_time;
+  size_t parse_threads = 1;
+  const char* path = NULL;
+  const char* source = NULL;
+  const char* load_cache = NULL;
+  const char* write_cache = NULL;
+  bool sat;
+  int opt;
 
   clause_set_init(&set);
+  clause_set_solve_options_init(&options);
+
+  while ((opt = getopt(argc, argv, "m:r:j:p:c:w:es")) != -1) {
+    if (opt == 'm' && strcmp(optarg, "dpll") == 0)
+      options.mode = solve_mode_dpll;
+    else if (opt == 'm' && strcmp(optarg, "cdcl") == 0)
+      options.mode = solve_mode_cdcl;
+    else if (opt == 'r' && strcmp(optarg, "none") == 0)
+      options.restarts = restarts_none;
+    else if (opt == 'r' && strcmp(optarg, "luby") == 0)
+      options.restarts = restarts_luby;
+    else if (opt == 'r' && strcmp(optarg, "glucose") == 0)
+      options.restarts = restarts_glucose;
+    else if (opt == 'j')
+      parse_threads = (size_t) strtoul(optarg, NULL, 10);
+    else if (opt == 'p')
+      options.threads = (size_t) strtoul(optarg, NULL, 10);
+    else if (opt == 'c')
+      load_cache = optarg;
+    else if (opt == 'w')
+      write_cache = optarg;
+    else if (opt == 'e')
+      options.eliminate = true;
+    else if (opt == 's')
+      options.stats = &stats;
+    else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
 
-  tstart = clock();
-  if (!clause_set_parse(&set, stdin)) {
-    printf("error: %s\n", dpll_errinfo);
+  if (optind + 1 < argc) {
+    usage(argv[0]);
     return EXIT_FAILURE;
   }
-  tdelta = clock() - tstart;
-  fprintf(stderr, "parsing: %f seconds\n", (double) tdelta / CLOCKS_PER_SEC);
+  if (optind < argc)
+    path = argv[optind];
+
+  // A cache of stdin can not be checked against its source.
+  if (path && strcmp(path, "-") != 0)
+    source = path;
+
+  // The parser may use several threads, thus the wall time is reported.
+  parse_start = wall_time();
+  if (load_cache && clause_set_load_cache(&set, load_cache, source)) {
+    fprintf(stderr, "loading cache: %f seconds\n", wall_time() - parse_start);
+  }
+  else {
+    if (load_cache)
+      fprintf(stderr, "%s\n", dpll_errinfo);
+    if (!clause_set_parse_file(&set, path, parse_threads)) {
+      printf("error: %s\n", dpll_errinfo);
+      return EXIT_FAILURE;
+    }
+    fprintf(stderr, "parsing: %f seconds\n", wall_time() - parse_start);
+    if (write_cache && !clause_set_write_cache(&set, write_cache, source))
+      fprintf(stderr, "%s\n", dpll_errinfo);
+  }
 
-  tstart = clock();
-  if (!clause_set_solve(&set, &values, sat_callback, NULL)) {
+  // The parallel solvers only search for the first solution. They run
+  // on several threads as well, thus the wall time is reported.
+  solve_start = wall_time();
+  if (options.threads != 1)
+    sat = clause_set_solve(&set, &options, &values, NULL, NULL);
+  else
+    sat = clause_set_solve(&set, &options, &values, sat_callback, NULL);
+  if (!sat) {
     fputs("UNSAT\n", stdout);
+    if (options.stats)
+      print_stats(options.stats);
     return EXIT_SUCCESS;
   }
-  tdelta = clock() - tstart;
-  fprintf(stdout, "solving: %f seconds\n", (double) tdelta / CLOCKS_PER_SEC);
+  solve_time = wall_time() - solve_start;
+  if (options.threads != 1)
+    sat_callback(set.num_vars, values, NULL);
+  if (options.stats)
+    print_stats(options.stats);
+  fprintf(stdout, "solving: %f seconds\n", solve_time);
 
   free(values);
   values = NULL;